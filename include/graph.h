@@ -5,6 +5,7 @@
 #include <queue>
 #include <vector>
 #include <algorithm>
+#include <functional>
 
 #include "io.h"
 
@@ -25,10 +26,21 @@ int topology_sort(AdjacentList g, const HLSInput &hin,
                   vector<vector<int>> &out);
 
 int topology_sort(AdjacentList g, const HLSInput &hin,
-                  const vector<int> &ot2rtid, vector<vector<int>> &out);
+                  const std::function<int(int)> &get_rtid,
+                  vector<vector<int>> &out);
 
 vector<pair<int, int>> sort_interval_graph(const HLSOutput &hout);
 
+// Induced graphs and topology orders of all basic blocks, built once and
+// shared read-only by phases.
+class CDFGCache {
+   public:
+    vector<AdjacentList> graphs;  // length = n_block
+    vector<vector<int>> topos;    // topology order of each block
+
+    CDFGCache(const HLSInput &hin);
+};
+
 };  // namespace hls
 
 #endif
\ No newline at end of file
@@ -37,6 +37,14 @@ enum OpCategory {
     OP_COMPARE,     // in1, in2 -> out
 };
 
+// Attributes of an operation type, as bit flags.
+// Given by an optional section after operations in the input:
+// n_attr, followed by n_attr lines of (optype, flags).
+enum OpAttr {
+    ATTR_COMMUTATIVE = 1,  // inputs could be swapped
+    ATTR_ASSOCIATIVE = 2,  // chains of it could be regrouped
+};
+
 // Description of a type of resources
 class ResourceType {
    public:
@@ -50,7 +58,7 @@ class ResourceType {
 
     int rtid;
 
-    ResourceType(std::ifstream &);
+    ResourceType(std::istream &);
     void print() const;
 };
 
@@ -69,7 +77,7 @@ class BasicBlock {
 
     int bbid;
 
-    BasicBlock(std::ifstream &);
+    BasicBlock(std::istream &);
     void print() const;
 };
 
@@ -83,7 +91,7 @@ class Operation {
     int bbid;
     int opid;
 
-    Operation(std::ifstream &);
+    Operation(std::istream &);
     void print() const;
 };
 
@@ -95,20 +103,29 @@ class HLSInput {
                           // categories
     float target_cp;      // maximum ns in one cycle
     int area_limit;       // total area limit
+    int reg_area = 0;     // area of one register, 0 if not modeled
     int n_block;          // length of blocks
     int n_operation;      // total operations
     std::vector<OpCategory> op_types;  // category of each operation type, 1~8
+    std::vector<int> op_attrs;         // attribute flags of each op type
     std::vector<ResourceType> resource_types;
     std::vector<BasicBlock> blocks;
     std::vector<Operation> operations;
 
     HLSInput(char *);
+    HLSInput(std::istream &);
     void print() const;
+    void write(std::ostream &) const;  // in the input format
 
     // Catchy translations
     OpCategory get_opcate(int opid) const;
     bool need_schedule(OpCategory) const;
     bool need_bind(OpCategory) const;
+    bool is_commutative(int optype) const;
+    bool is_associative(int optype) const;
+
+   private:
+    void load(std::istream &);
 };
 
 class HLSOutput {
@@ -120,6 +137,8 @@ class HLSOutput {
     const HLSInput *hin;
     // allocate type
     std::vector<int> ot2rtid;  // length of n_op_type
+    // per-op choice among compatible types, -1 to follow ot2rtid
+    std::vector<int> op2rtid;  // length of n_operation
 
     // allocate inst
     // Allocator must maintain correspondence on output
@@ -132,12 +151,16 @@ class HLSOutput {
     // binding
     std::vector<int> binds;  // length of n_operation
 
+    // register binding
+    int n_reg = 0;  // number of registers holding values across cycles
+
     HLSOutput(const HLSInput &hin) {
         this->n_resource_type = hin.n_resource_type;
         this->n_op_type = hin.n_op_type;
         this->n_operation = hin.n_operation;
         this->hin = &hin;
         ot2rtid.resize(n_op_type, -1);
+        op2rtid.resize(n_operation, -1);
         insts.resize(n_op_type, 0);
         rinsts.resize(n_resource_type, 0);
         scheds.resize(n_operation, -1);
@@ -145,6 +168,16 @@ class HLSOutput {
     }
 
     void output();
+
+    int get_rtid(int opid) const;  // resource type op runs on, or -1
+
+    // Metrics on results
+    int get_latency(int opid) const;  // latency of op's resource type
+    // Cycle range [start, end) of scheduled ops in a block.
+    // Returns false if the block has no scheduled op.
+    bool get_block_range(int bbid, int &start, int &end) const;
+    float get_weighted_latency() const;  // sum of block length * exp_times
+    int get_area() const;                // including registers
 };
 };  // namespace hls
 
@@ -0,0 +1,57 @@
+#ifndef HLS_RESERVATION_H
+#define HLS_RESERVATION_H
+
+#include <vector>
+
+#include "io.h"
+
+using std::vector;
+
+namespace hls {
+
+// Cycles an op occupies its resource instance.
+// Pipelined units accept a new op every cycle,
+// others are busy until the result is ready.
+int get_occupancy(const ResourceType &rt);
+
+// Per-cycle reservation table of resource instances
+// Counts busy insts of each resource type at each cycle, and optionally
+// which insts are busy, growing with the cycles reserved.
+// Reserving and querying a cycle takes O(1), an op takes O(occupancy).
+class ReservationTable {
+   private:
+    vector<int> occupancy;                // rtid -> cycles an op takes
+    vector<int> capacity;                 // rtid -> num of insts, 0 if no limit
+    vector<vector<int>> counts;           // rtid -> cycle -> busy insts
+    vector<vector<vector<bool>>> slots;   // rtid -> inst -> cycle -> busy
+
+    void update(int rtid, int cycle, int delta);
+
+   public:
+    ReservationTable(const HLSInput &hin, const vector<int> &capacity);
+
+    int get_occupancy(int rtid) const { return occupancy[rtid]; }
+    int get_capacity(int rtid) const { return capacity[rtid]; }
+
+    // Num of busy insts of rtid at cycle
+    int get_busy(int rtid, int cycle) const;
+    // An op of rtid starting at cycle fits in the capacity
+    bool is_free(int rtid, int cycle) const;
+    // First cycle no earlier than from, where an op of rtid fits
+    int first_fit(int rtid, int from) const;
+    // Reserve or release an op of rtid starting at cycle, on no inst
+    void reserve(int rtid, int cycle);
+    void release(int rtid, int cycle);
+
+    // Same as above, on a specific inst
+    bool is_inst_free(int rtid, int inst, int cycle) const;
+    // First inst free for an op of rtid starting at cycle, -1 if none.
+    // Insts are limited by capacity if any, otherwise by insts seen.
+    int first_free_inst(int rtid, int cycle) const;
+    void reserve_inst(int rtid, int inst, int cycle);
+    void release_inst(int rtid, int inst, int cycle);
+};
+
+};  // namespace hls
+
+#endif
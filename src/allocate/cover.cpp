@@ -0,0 +1,71 @@
+#include "cover.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace hls {
+
+// Max num of items in order[pos:] fitting in remaining area.
+// Items are sorted by area, so the smallest ones form a prefix, and the
+// LP relaxation of the cardinality knapsack rounds down to its length.
+int CoverSolver::get_bound(int pos, int remain) const {
+    long long target = prefix[pos] + remain;
+    int end = std::upper_bound(prefix.begin() + pos, prefix.end(), target) -
+              prefix.begin();
+    return end - 1 - pos;
+}
+
+void CoverSolver::search(int pos, uint64_t covered, int area, int cnt) {
+    if (((covered | suffix[pos]) & required) != required) return;
+    if (pos == n_item) {
+        if (cnt > best_cnt) {
+            best_cnt = cnt;
+            for (int i = 0; i < n_item; i++) chosen[order[i]] = now[i];
+        }
+        return;
+    }
+    if (cnt + get_bound(pos, area_limit - area) <= best_cnt) return;
+
+    int item = order[pos];
+    // take the item
+    if (n_forbid[pos] == 0 && area + areas[item] <= area_limit) {
+        now[pos] = true;
+        search(pos + 1, covered | masks[item], area + areas[item], cnt + 1);
+        now[pos] = false;
+    }
+    // skip the item, and those dominated by it
+    for (auto d : dominated[pos]) n_forbid[d]++;
+    search(pos + 1, covered, area, cnt);
+    for (auto d : dominated[pos]) n_forbid[d]--;
+}
+
+int CoverSolver::solve() {
+    order.resize(n_item);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](int a, int b) { return areas[a] < areas[b]; });
+
+    suffix.assign(n_item + 1, 0);
+    for (int i = n_item - 1; i >= 0; i--)
+        suffix[i] = suffix[i + 1] | masks[order[i]];
+    prefix.assign(n_item + 1, 0);
+    for (int i = 0; i < n_item; i++)
+        prefix[i + 1] = prefix[i] + areas[order[i]];
+
+    // any solution taking j but not i could swap j for i, if i comes first,
+    // covers all of j and has no more area
+    dominated.assign(n_item, vector<int>());
+    for (int i = 0; i < n_item; i++) {
+        uint64_t mi = masks[order[i]];
+        for (int j = i + 1; j < n_item; j++)
+            if ((masks[order[j]] & ~mi) == 0) dominated[i].push_back(j);
+    }
+    n_forbid.assign(n_item, 0);
+
+    now.assign(n_item, false);
+    best_cnt = -1;
+    search(0, 0, 0, 0);
+    return best_cnt;
+}
+
+}  // namespace hls
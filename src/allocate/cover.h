@@ -0,0 +1,57 @@
+#ifndef HLS_ALLOCATE_COVER_H
+#define HLS_ALLOCATE_COVER_H
+
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+namespace hls {
+
+// Exact solver of the resource type selection model:
+// choose a maximum number of items with total area under the limit,
+// whose coverage bitmasks together cover the required mask.
+// Branch and bound over items sorted by area, with
+// - a cover check against the union of remaining items,
+// - the LP relaxation of the cardinality knapsack as upper bound,
+// - dominance: once an item is skipped, later items with no less area
+//   and a subset of its coverage are skipped as well.
+class CoverSolver {
+   private:
+    int n_item;
+    vector<uint64_t> masks;
+    vector<int> areas;
+    uint64_t required;
+    int area_limit;
+
+    vector<int> order;           // items sorted by area
+    vector<uint64_t> suffix;     // union of masks of order[i:]
+    vector<long long> prefix;    // sum of areas of order[:i]
+    vector<vector<int>> dominated;  // position -> later positions dominated
+    vector<int> n_forbid;           // position -> num of skipped dominators
+
+    vector<bool> now;
+    int best_cnt = -1;
+
+    int get_bound(int pos, int remain) const;
+    void search(int pos, uint64_t covered, int area, int cnt);
+
+   public:
+    vector<bool> chosen;  // result, length of n_item
+
+    CoverSolver(const vector<uint64_t> &masks, const vector<int> &areas,
+                uint64_t required, int area_limit)
+        : masks(masks), areas(areas) {
+        this->n_item = masks.size();
+        this->required = required;
+        this->area_limit = area_limit;
+        chosen.resize(n_item, false);
+    }
+
+    // Returns the optimal number of chosen items, -1 if infeasible.
+    int solve();
+};
+
+}  // namespace hls
+
+#endif
@@ -1,13 +1,58 @@
 #include "ilp.h"
 
+#include "cover.h"
+
 namespace hls {
 
 const float theta_pipeline = 2.0;
+const int max_cover_bits = 64;    // coverage must fit in the bitmask
+const int max_cover_items = 64;   // larger libraries go to lp_solve
 
-// Use ILP to allocate resource types.
+// Allocate resource types.
 // Assume all resource types are instantiated once, under the given area limit,
 // find the set with maximum size that could cover all operation types.
+// Solve the model with the built-in cover solver, or with lp_solve if
+// there are too many op types for the bitmask or too many resource types.
 int ILPAllocator::allocate_resource_type() {
+    // op types needing resources -> bits
+    vector<int> ot2bit(hin->n_op_type, -1);
+    int n_bit = 0;
+    for (int ot = 0; ot < hin->n_op_type; ot++)
+        if (hin->need_schedule(hin->op_types[ot])) ot2bit[ot] = n_bit++;
+    if (n_bit > max_cover_bits || hin->n_resource_type > max_cover_items)
+        return allocate_resource_type_lp();
+
+    // useless resources are free to choose, others are items to cover
+    vector<uint64_t> masks;
+    vector<int> areas, items;
+    for (const auto &rt : hin->resource_types) {
+        if (rt.n_comp_op == 0) {
+            rtypes[rt.rtid] = true;
+            continue;
+        }
+        uint64_t mask = 0;
+        for (auto ot : rt.comp_ops)
+            if (ot2bit[ot] != -1) mask |= (uint64_t)1 << ot2bit[ot];
+        masks.push_back(mask);
+        areas.push_back(rt.area);
+        items.push_back(rt.rtid);
+    }
+    uint64_t required =
+        (n_bit == 64) ? ~(uint64_t)0 : ((uint64_t)1 << n_bit) - 1;
+
+    CoverSolver solver(masks, areas, required, hin->area_limit);
+    if (solver.solve() < 0) {
+        cerr << "Error: no resource types could cover all operation types"
+             << endl;
+        return -1;
+    }
+    for (int i = 0; i < (int)items.size(); i++)
+        rtypes[items[i]] = solver.chosen[i];
+    return 0;
+}
+
+// Use ILP to allocate resource types, same model as above
+int ILPAllocator::allocate_resource_type_lp() {
     int *colno = new int[hin->n_resource_type];  // ordered by bb.ops
     REAL *row = new REAL[hin->n_resource_type];
     int ret = 0;  // if ret == -1, will skip to cleaning up
@@ -122,6 +167,224 @@ int ILPAllocator::allocate_operation_type() {
     return 0;
 }
 
+// Jointly allocate resource types, operation types and num of instances.
+// Latency of optype o on k insts of rtype r is estimated from merged depth
+// profiles, and the model minimizes total expected latency under area limit:
+//   y_r:   rtype r is used
+//   x_or:  optype o is allocated to rtype r
+//   z_rk:  rtype r has k insts, sum_k z_rk = y_r
+//   w_ork: linearized x_or * z_rk, weighted by latency of (o, r, k)
+// Each optype is estimated as if it owned all insts of its rtype.
+// Returns 0 on success, -1 on errors.
+int ILPAllocator::allocate_joint(PerfProfiler *shared) {
+    std::unique_ptr<PerfProfiler> own_profiler;
+    if (!shared) {
+        own_profiler.reset(new PerfProfiler(*hin));
+        shared = own_profiler.get();
+    }
+    PerfProfiler &profiler = *shared;
+    int n_rt = hin->n_resource_type;
+
+    // Optypes only scheduled but never binded are not limited by insts,
+    // so simply pick their fastest compatible rtype.
+    for (int ot = 0; ot < hin->n_op_type; ot++) {
+        auto opcate = hin->op_types[ot];
+        if (!hin->need_schedule(opcate) || hin->need_bind(opcate)) continue;
+        int width = std::max(1, profiler.get_max_width(ot));
+        float perf = std::numeric_limits<float>::infinity();
+        for (auto rtid : ot2comprt[ot]) {
+            const auto &rt = hin->resource_types[rtid];
+            float now_perf = profiler.estimate_perf(ot, rt, width);
+            if (now_perf < perf) {
+                perf = now_perf;
+                ot2rtid[ot] = rtid;
+            }
+        }
+        if (ot2rtid[ot] == -1) {
+            cerr << "Error: optype " << ot << " didn't get allocated!" << endl;
+            return -1;
+        }
+        rtypes[ot2rtid[ot]] = true;
+    }
+
+    // More insts than the widest depth level never help
+    vector<int> max_insts(n_rt, 0);
+    for (const auto &rt : hin->resource_types) {
+        int width = 0;
+        for (auto ot : rt.comp_ops)
+            if (hin->need_bind(hin->op_types[ot]))
+                width = std::max(width, profiler.get_max_width(ot));
+        if (rt.area > 0) width = std::min(width, hin->area_limit / rt.area);
+        max_insts[rt.rtid] = width;
+    }
+
+    // Number columns of the model, starting from 1
+    int n_col = 0;
+    vector<int> ycol(n_rt, 0);
+    vector<vector<int>> zcol(n_rt);  // zcol[r][k - 1]
+    map<pair<int, int>, int> xcol;   // (o, r) -> column
+    map<pair<int, int>, int> wcol;   // (o, r) -> column of w_or1
+    for (int rtid = 0; rtid < n_rt; rtid++) {
+        if (max_insts[rtid] == 0) continue;
+        ycol[rtid] = ++n_col;
+        for (int k = 1; k <= max_insts[rtid]; k++) zcol[rtid].push_back(++n_col);
+    }
+    for (int ot = 0; ot < hin->n_op_type; ot++) {
+        if (!hin->need_bind(hin->op_types[ot])) continue;
+        for (auto rtid : ot2comprt[ot]) {
+            if (max_insts[rtid] == 0) continue;
+            xcol[std::make_pair(ot, rtid)] = ++n_col;
+            wcol[std::make_pair(ot, rtid)] = n_col + 1;
+            n_col += max_insts[rtid];
+        }
+    }
+
+    int *colno = new int[n_col + 1];
+    REAL *row = new REAL[n_col + 1];
+    int ret = 0;  // if ret == -1, will skip to cleaning up
+
+    auto lp = make_lp(0, n_col);
+    if (lp == 0) ret = -1;
+    if (!ret) {
+        set_add_rowmode(lp, TRUE);
+        for (int rtid = 0; rtid < n_rt; rtid++) {
+            if (max_insts[rtid] == 0) continue;
+            set_binary(lp, ycol[rtid], TRUE);
+            for (auto col : zcol[rtid]) set_binary(lp, col, TRUE);
+        }
+        for (const auto &it : xcol) set_binary(lp, it.second, TRUE);
+    }
+
+#ifndef DEBUG_HLS_SCHEDULE_SDC
+    if (lp) set_verbose(lp, IMPORTANT);
+#endif
+
+    // each binded optype is allocated to exactly one rtype
+    for (int ot = 0; ot < hin->n_op_type && !ret; ot++) {
+        if (!hin->need_bind(hin->op_types[ot])) continue;
+        int cnt = 0;
+        for (auto rtid : ot2comprt[ot]) {
+            if (max_insts[rtid] == 0) continue;
+            colno[cnt] = xcol[std::make_pair(ot, rtid)];
+            row[cnt] = 1;
+            cnt++;
+        }
+        if (cnt == 0) {
+            cerr << "Error: optype " << ot << " has no affordable rtype" << endl;
+            ret = -1;
+        } else if (!add_constraintex(lp, cnt, row, colno, EQ, 1)) {
+            cerr << "Error: adding operation type constraints" << endl;
+            ret = -1;
+        }
+    }
+
+    // x_or <= y_r
+    for (auto it = xcol.begin(); it != xcol.end() && !ret; it++) {
+        colno[0] = it->second;
+        colno[1] = ycol[it->first.second];
+        row[0] = 1;
+        row[1] = -1;
+        if (!add_constraintex(lp, 2, row, colno, LE, 0)) ret = -1;
+    }
+
+    // sum_k z_rk = y_r
+    for (int rtid = 0; rtid < n_rt && !ret; rtid++) {
+        if (max_insts[rtid] == 0) continue;
+        int cnt = 0;
+        for (auto col : zcol[rtid]) {
+            colno[cnt] = col;
+            row[cnt] = 1;
+            cnt++;
+        }
+        colno[cnt] = ycol[rtid];
+        row[cnt] = -1;
+        cnt++;
+        if (!add_constraintex(lp, cnt, row, colno, EQ, 0)) ret = -1;
+    }
+
+    // area constraints
+    if (!ret) {
+        int cnt = 0;
+        for (int rtid = 0; rtid < n_rt; rtid++) {
+            int area = hin->resource_types[rtid].area;
+            for (int k = 1; k <= (int)zcol[rtid].size(); k++) {
+                colno[cnt] = zcol[rtid][k - 1];
+                row[cnt] = area * k;
+                cnt++;
+            }
+        }
+        if (!add_constraintex(lp, cnt, row, colno, LE, hin->area_limit)) {
+            cerr << "Error: adding area constraints" << endl;
+            ret = -1;
+        }
+    }
+
+    // w_ork >= x_or + z_rk - 1
+    for (auto it = xcol.begin(); it != xcol.end() && !ret; it++) {
+        int rtid = it->first.second;
+        int w = wcol[it->first];
+        for (int k = 1; k <= max_insts[rtid]; k++) {
+            colno[0] = w + k - 1;
+            colno[1] = it->second;
+            colno[2] = zcol[rtid][k - 1];
+            row[0] = 1;
+            row[1] = -1;
+            row[2] = -1;
+            if (!add_constraintex(lp, 3, row, colno, GE, -1)) ret = -1;
+        }
+    }
+
+    // set objective: minimize expected latency
+    if (!ret) {
+        set_add_rowmode(lp, FALSE);
+        set_minim(lp);
+        int cnt = 0;
+        for (auto it = xcol.begin(); it != xcol.end(); it++) {
+            int ot = it->first.first;
+            int rtid = it->first.second;
+            const auto &rt = hin->resource_types[rtid];
+            int w = wcol[it->first];
+            for (int k = 1; k <= max_insts[rtid]; k++) {
+                colno[cnt] = w + k - 1;
+                row[cnt] = profiler.estimate_perf(ot, rt, k);
+                cnt++;
+            }
+        }
+        if (!set_obj_fnex(lp, cnt, row, colno)) {
+            cerr << "Error: setting objective functions" << endl;
+            ret = -1;
+        }
+    }
+
+    // run the model and fetch the result
+    if (!ret) {
+        int ret_lp = solve(lp);
+        if (!(ret_lp == OPTIMAL || ret_lp == SUBOPTIMAL)) {
+            cerr << "LP fails with return value = " << ret_lp << endl;
+            ret = -1;
+        }
+    }
+    if (!ret) {
+        get_variables(lp, row);
+        for (int rtid = 0; rtid < n_rt; rtid++) {
+            if (max_insts[rtid] == 0) continue;
+            if ((int)(row[ycol[rtid] - 1] + 0.5) == 1) rtypes[rtid] = true;
+            for (int k = 1; k <= max_insts[rtid]; k++)
+                if ((int)(row[zcol[rtid][k - 1] - 1] + 0.5) == 1)
+                    rinsts[rtid] = k;
+        }
+        for (auto it = xcol.begin(); it != xcol.end(); it++)
+            if ((int)(row[it->second - 1] + 0.5) == 1)
+                ot2rtid[it->first.first] = it->first.second;
+    }
+
+    // cleaning up
+    if (lp) delete_lp(lp);
+    delete[] colno;
+    delete[] row;
+    return ret;
+}
+
 class QueueNode {
    public:
     float exp_time;
@@ -142,9 +405,9 @@ class QueueNode {
 };
 
 // Returns 0 on success, 1 on needless to bind, -1 on errors.
-int ILPAllocator::allocate_insts_bound(vector<int> &rinsts) {
-    // get current total area used
-    int total_area = 0;
+int ILPAllocator::allocate_insts_bound(vector<int> &rinsts, int n_reg) {
+    // get current total area used, registers included
+    int total_area = n_reg * hin->reg_area;
     for (int rtid = 0; rtid < hin->n_resource_type; rtid++) {
         const auto &rt = hin->resource_types[rtid];
         total_area += rinsts[rtid] * rt.area;
@@ -157,7 +420,7 @@ int ILPAllocator::allocate_insts_bound(vector<int> &rinsts) {
     for (const auto &op : hin->operations) {
         int rtid = ot2rtid[op.optype];
         if (rtid == -1) continue;
-        const auto &bb = hin->blocks[op.opid];
+        const auto &bb = hin->blocks[op.bbid];
         exp_times[rtid] += bb.exp_times;
     }
 
@@ -173,6 +436,10 @@ int ILPAllocator::allocate_insts_bound(vector<int> &rinsts) {
     }
 
     while (total_area > hin->area_limit) {
+        if (q.empty()) {
+            cerr << "Warning: area limit can't be met by cutting insts" << endl;
+            break;
+        }
         auto n = q.top();
         q.pop();
 
@@ -3,6 +3,7 @@
 
 #include "io.h"
 #include "lp_lib.h"
+#include "perf.h"
 #include <limits>
 
 namespace hls {
@@ -12,15 +13,19 @@ class ILPAllocator {
     const HLSInput *hin;
     vector<bool> rtypes;  // the chosen resource types to use
     vector<int> ot2rtid;  // optype binds to which resource type?
+    vector<int> rinsts;   // num of insts of each rtype, set by joint ILP
     vector<vector<int>> ot2comprt;  // optype -> compatible rtype
 
+    int allocate_resource_type_lp();
+
    public:
     ILPAllocator(const HLSInput &hin) {
         this->hin = &hin;
         this->rtypes.resize(hin.n_resource_type, false);
         this->ot2rtid.resize(hin.n_op_type, -1);
+        this->rinsts.resize(hin.n_resource_type, 0);
 
-        this->ot2comprt.resize(hin.n_resource_type);
+        this->ot2comprt.resize(hin.n_op_type);
         for (const auto &rt : hin.resource_types)
             for (auto ot : rt.comp_ops)
                 ot2comprt[ot].push_back(rt.rtid);
@@ -34,14 +39,22 @@ class ILPAllocator {
     // Returns 0 on success, -1 on errors.
     int allocate_operation_type();
 
-    // Set upper bounds for resource insts if binding exceeds area limit
+    // Allocate resource types, operation types and num of insts in one ILP,
+    // estimating latency with a shared profiler if given.
     // Returns 0 on success, -1 on errors.
-    int allocate_insts_bound(vector<int> &rinsts);
+    int allocate_joint(PerfProfiler *shared = nullptr);
+
+    // Set upper bounds for resource insts if binding exceeds area limit,
+    // counting area of n_reg registers as well.
+    // Returns 0 on success, 1 on needless to bind, -1 on errors.
+    int allocate_insts_bound(vector<int> &rinsts, int n_reg = 0);
 
-    // Copyout type allocation results
+    // Copyout type allocation results, and insts if jointly allocated
     void copyout(HLSOutput &hout) {
         for (int i = 0; i < hin->n_op_type; i++)
             hout.ot2rtid[i] = ot2rtid[i];
+        for (int i = 0; i < hin->n_resource_type; i++)
+            hout.rinsts[i] = rinsts[i];
     }
 };
 
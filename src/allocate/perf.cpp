@@ -1,9 +1,11 @@
 #include "perf.h"
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <map>
 #include <queue>
+#include <thread>
 using std::cerr;
 using std::endl;
 using std::map;
@@ -72,6 +74,17 @@ void AbstractedCDFG::print() {
     cout << endl;
 }
 
+// Expected latency of finishing n ops on the same depth level,
+// given the allocated resource type and number of resources.
+float estimate_level_perf(int n, const ResourceType &rtype, int num,
+                          float target_cp) {
+    float lat = rtype.latency;
+    float delay = rtype.delay;
+    if (rtype.is_pipelined)
+        return target_cp * (lat + floorf((float)n / num)) + delay;
+    return ceilf((float)n / num) * (target_cp * lat + delay);
+}
+
 // Estimate expected performance of optype in this basic block,
 // given its allocated resource type and number of resources.
 // A rough estimation: optype must finish ops of depths k before
@@ -79,32 +92,78 @@ void AbstractedCDFG::print() {
 // Return an expected latency on success, negative values on error.
 float AbstractedCDFG::estimate_perf(int optype, const ResourceType &rtype,
                                     int num) {
-    float target_cp = hin->target_cp;
-    float lat = rtype.latency;
-    float delay = rtype.delay;
     float res = 0;
-    for (int i = 0; i < dependencies[optype].size(); i++) {
-        int n = dependencies[optype][i];
-        float tmp = 0;
-        if (rtype.is_pipelined) {
-            tmp = target_cp * (lat + floorf((float)n / num)) + delay;
-        } else {
-            tmp = ceilf((float)n / num) * (target_cp * lat + delay);
-        }
-        res += tmp;
-    }
+    for (auto n : dependencies[optype])
+        res += estimate_level_perf(n, rtype, num, hin->target_cp);
     res *= hin->blocks[bbid].exp_times;
     return res;
 }
 
-// Run estimation on all basic blocks
+// Build abstracted CDFGs of all basic blocks on multiple threads
+void PerfProfiler::build_cdfgs() {
+    int n_thread = std::max(1u, std::thread::hardware_concurrency());
+    n_thread = std::min(n_thread, n_block);
+    if (n_thread <= 1) {
+        for (int i = 0; i < n_block; i++)
+            cdfgs.push_back(AbstractedCDFG(n_op_type, i, *hin));
+        return;
+    }
+
+    // each worker builds a contiguous range of blocks
+    vector<vector<AbstractedCDFG>> parts(n_thread);
+    vector<std::thread> workers;
+    int chunk = (n_block + n_thread - 1) / n_thread;
+    for (int t = 0; t < n_thread; t++) {
+        workers.emplace_back([this, &parts, t, chunk]() {
+            int end = std::min(n_block, (t + 1) * chunk);
+            for (int i = t * chunk; i < end; i++)
+                parts[t].push_back(AbstractedCDFG(n_op_type, i, *hin));
+        });
+    }
+    for (auto &w : workers) w.join();
+
+    cdfgs.reserve(n_block);
+    for (auto &part : parts)
+        for (auto &cdfg : part) cdfgs.push_back(std::move(cdfg));
+}
+
+// Merge depth histograms of all basic blocks into one profile per optype,
+// weighting each depth level by its block's exp_times.
+void PerfProfiler::build_profiles() {
+    profiles.resize(n_op_type);
+    for (const auto &cdfg : cdfgs) {
+        float exp_times = hin->blocks[cdfg.bbid].exp_times;
+        for (int optype = 0; optype < n_op_type; optype++)
+            for (auto n : cdfg.dependencies[optype])
+                profiles[optype][n] += exp_times;
+    }
+}
+
+int PerfProfiler::get_max_width(int optype) const {
+    const auto &profile = profiles[optype];
+    if (profile.empty()) return 0;
+    return profile.rbegin()->first;
+}
+
+// Run estimation on the merged profile, independent of block count.
+// Results are memoized on (optype, rtid, num).
 // Return an expected latency
-float PerfAllocator::estimate_perf(int optype, const ResourceType &rtype,
-                                   int num) {
+float PerfProfiler::estimate_perf(int optype, const ResourceType &rtype,
+                                  int num) {
+    auto key = std::make_tuple(optype, rtype.rtid, num);
+    {
+        std::lock_guard<std::mutex> lock(cache_mtx);
+        auto it = perf_cache.find(key);
+        if (it != perf_cache.end()) return it->second;
+    }
+
     float exp_perf = 0;
-    for (int i = 0; i < n_block; i++) {
-        exp_perf += cdfgs[i].estimate_perf(optype, rtype, num);
+    for (const auto &level : profiles[optype]) {
+        exp_perf += level.second *
+                    estimate_level_perf(level.first, rtype, num, hin->target_cp);
     }
+    std::lock_guard<std::mutex> lock(cache_mtx);
+    perf_cache.insert(std::make_pair(key, exp_perf));
     return exp_perf;
 }
 
@@ -5,6 +5,9 @@
 #include <queue>
 #include <map>
 #include <cmath>
+#include <memory>
+#include <mutex>
+#include <tuple>
 
 #include "area.h"
 #include "io.h"
@@ -16,6 +19,14 @@ using std::map;
 
 namespace hls {
 
+// Depth profile of an optype, merged over all basic blocks.
+// Maps number of ops on one depth level -> sum of exp_times of such levels.
+typedef map<int, float> PerfProfile;
+
+// Expected latency of finishing n ops on the same depth level
+float estimate_level_perf(int n, const ResourceType &rtype, int num,
+                          float target_cp);
+
 // Abstracted CDFG of a basic block
 class AbstractedCDFG {
 public:
@@ -37,23 +48,62 @@ public:
 
 };
 
-// Allocate each operation w.r.t. its expected latency and area.
-class PerfAllocator : public AreaAllocator {
+// Depth profiles of all basic blocks, merged for cheap latency estimation.
+// Profiles are read-only once built, and the memo of estimate_perf is
+// locked, so one profiler could be shared by threads.
+class PerfProfiler {
    private:
+    int n_op_type = 0;
     int n_block = 0;
+    const HLSInput *hin = nullptr;
     vector<AbstractedCDFG> cdfgs;
+    vector<PerfProfile> profiles;  // length = n_op_type
+    map<std::tuple<int, int, int>, float> perf_cache;  // (optype, rtid, num)
+    std::mutex cache_mtx;                              // guards perf_cache
+
+    void build_cdfgs();
+    void build_profiles();
 
    public:
-    PerfAllocator(const HLSInput &hin) : AreaAllocator(hin) {
-        // initialize abstracted CDFG
+    PerfProfiler(const HLSInput &hin) {
+        this->hin = &hin;
+        n_op_type = hin.n_op_type;
         n_block = hin.n_block;
-        for (int i = 0; i < n_block; i++) {
-            cdfgs.push_back(AbstractedCDFG(n_op_type, i, hin));
+        build_cdfgs();
+        build_profiles();
+    }
+
+    const PerfProfile &get_profile(int optype) const {
+        return profiles[optype];
+    }
+
+    // Maximum number of ops of optype on one depth level of any block
+    int get_max_width(int optype) const;
+
+    float estimate_perf(int optype, const ResourceType &rtype, int num);
+};
+
+// Allocate each operation w.r.t. its expected latency and area.
+// A shared profiler could be given, otherwise it builds its own.
+class PerfAllocator : public AreaAllocator {
+   private:
+    std::unique_ptr<PerfProfiler> own_profiler;
+    PerfProfiler *profiler;
+
+   public:
+    PerfAllocator(const HLSInput &hin, PerfProfiler *shared = nullptr)
+        : AreaAllocator(hin) {
+        if (!shared) {
+            own_profiler.reset(new PerfProfiler(hin));
+            shared = own_profiler.get();
         }
+        profiler = shared;
     }
     void allocate_type(int area_limit);
     void allocate_inst();
-    float estimate_perf(int optype, const ResourceType &rtype, int num);
+    float estimate_perf(int optype, const ResourceType &rtype, int num) {
+        return profiler->estimate_perf(optype, rtype, num);
+    }
 };
 
 // Evaluation on adding one more resource instance
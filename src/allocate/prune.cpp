@@ -0,0 +1,85 @@
+#include "prune.h"
+
+#include <algorithm>
+
+namespace hls {
+
+bool TypePruner::is_dominated(const ResourceType &a,
+                              const ResourceType &b) const {
+    if (a.is_sequential != b.is_sequential) return false;
+    if (a.is_pipelined && !b.is_pipelined) return false;
+    if (b.area > a.area || b.latency > a.latency || b.delay > a.delay)
+        return false;
+    for (auto ot : a.comp_ops)
+        if (std::find(b.comp_ops.begin(), b.comp_ops.end(), ot) ==
+            b.comp_ops.end())
+            return false;
+    return true;
+}
+
+int TypePruner::prune() {
+    int n = hin->n_resource_type;
+    const auto &rts = hin->resource_types;
+
+    // a type is removed if it's dominated by a kept one. Among types
+    // dominating each other (duplicates), keep the one of minimum rtid.
+    for (int a = 0; a < n; a++) {
+        if (rts[a].n_comp_op == 0) {
+            dominators[a] = a;  // useless at all
+            continue;
+        }
+        for (int b = 0; b < n && dominators[a] == -1; b++) {
+            if (a == b || !is_dominated(rts[a], rts[b])) continue;
+            if (is_dominated(rts[b], rts[a]) && b > a) continue;
+            dominators[a] = b;
+        }
+    }
+
+    // Dominance is transitive, so some non-dominated type dominates each
+    // removed one. Keep the rest in their original order.
+    reduced.resource_types.clear();
+    new2old.clear();
+    for (int a = 0; a < n; a++) {
+        if (dominators[a] != -1) continue;
+        old2new[a] = new2old.size();
+        new2old.push_back(a);
+        reduced.resource_types.push_back(rts[a]);
+        reduced.resource_types.back().rtid = old2new[a];
+    }
+    reduced.n_resource_type = new2old.size();
+    return n - reduced.n_resource_type;
+}
+
+void TypePruner::copyout(const HLSOutput &hout_reduced, HLSOutput &hout) const {
+    for (int ot = 0; ot < hin->n_op_type; ot++) {
+        int rtid = hout_reduced.ot2rtid[ot];
+        hout.ot2rtid[ot] = (rtid == -1) ? -1 : new2old[rtid];
+        hout.insts[ot] = hout_reduced.insts[ot];
+    }
+    std::fill(hout.rinsts.begin(), hout.rinsts.end(), 0);
+    for (int rtid = 0; rtid < reduced.n_resource_type; rtid++)
+        hout.rinsts[new2old[rtid]] = hout_reduced.rinsts[rtid];
+    for (int opid = 0; opid < hin->n_operation; opid++) {
+        int rtid = hout_reduced.op2rtid[opid];
+        hout.op2rtid[opid] = (rtid == -1) ? -1 : new2old[rtid];
+    }
+    hout.scheds = hout_reduced.scheds;
+    hout.binds = hout_reduced.binds;
+    hout.n_reg = hout_reduced.n_reg;
+}
+
+void TypePruner::print() const {
+    int n_removed = hin->n_resource_type - reduced.n_resource_type;
+    cerr << "Type Pruner: removed " << n_removed << " of "
+         << hin->n_resource_type << " resource types" << endl;
+    for (int a = 0; a < hin->n_resource_type; a++) {
+        if (dominators[a] == -1) continue;
+        if (dominators[a] == a)
+            cerr << "  rtype " << a << ": no compatible op" << endl;
+        else
+            cerr << "  rtype " << a << ": dominated by " << dominators[a]
+                 << endl;
+    }
+}
+
+}  // namespace hls
@@ -0,0 +1,46 @@
+#ifndef HLS_ALLOCATE_PRUNE_H
+#define HLS_ALLOCATE_PRUNE_H
+
+#include <vector>
+
+#include "io.h"
+
+using std::vector;
+
+namespace hls {
+
+// Remove dominated and duplicated resource types before allocation.
+// Type a is dominated by type b, if b has no larger area, latency or delay,
+// is pipelined whenever a is, and is compatible with all ops of a.
+// Allocators, schedulers and binders then run on the reduced input,
+// whose results are mapped back to ids of the original input.
+class TypePruner {
+   private:
+    const HLSInput *hin;
+    HLSInput reduced;        // input with the kept resource types only
+    vector<int> old2new;     // original rtid -> reduced rtid, -1 if removed
+    vector<int> new2old;     // reduced rtid -> original rtid
+    vector<int> dominators;  // original rtid -> rtid dominating it, or -1
+
+    bool is_dominated(const ResourceType &a, const ResourceType &b) const;
+
+   public:
+    TypePruner(const HLSInput &hin) : reduced(hin) {
+        this->hin = &hin;
+        old2new.resize(hin.n_resource_type, -1);
+        dominators.resize(hin.n_resource_type, -1);
+    }
+
+    // Returns the number of removed types.
+    int prune();
+
+    const HLSInput &get_reduced() const { return reduced; }
+
+    // Map results on the reduced input back to the original one
+    void copyout(const HLSOutput &hout_reduced, HLSOutput &hout) const;
+    void print() const;
+};
+
+}  // namespace hls
+
+#endif
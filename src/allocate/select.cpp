@@ -0,0 +1,160 @@
+#include "select.h"
+
+#include <algorithm>
+#include <iostream>
+#include <tuple>
+
+#include "reservation.h"
+
+using std::cerr;
+using std::endl;
+
+namespace hls {
+
+int TypeSelector::get_latency(int rtid) const {
+    return rtid == -1 ? 0 : hin->resource_types[rtid].latency;
+}
+
+bool TypeSelector::is_compatible(int opid, int rtid) const {
+    const auto &comp = hin->resource_types[rtid].comp_ops;
+    int optype = hin->operations[opid].optype;
+    return std::find(comp.begin(), comp.end(), optype) != comp.end();
+}
+
+// Slack of an op is the number of cycles it could be delayed without
+// delaying its users in the same block or the end of the block
+void TypeSelector::analyze_slack() {
+    vector<int> ends(n_operation, -1);
+    for (int opid = 0; opid < n_operation; opid++)
+        if (hout->scheds[opid] >= 0)
+            ends[opid] = hout->scheds[opid] + hout->get_latency(opid) + 1;
+
+    for (const auto &bb : hin->blocks) {
+        int start, end;
+        if (!hout->get_block_range(bb.bbid, start, end)) continue;
+        for (auto opid : bb.ops)
+            if (ends[opid] >= 0) slacks[opid] = end - ends[opid];
+    }
+    for (int opid = 0; opid < n_operation; opid++) {
+        if (ends[opid] < 0) continue;
+        const auto &op = hin->operations[opid];
+        for (auto input : op.inputs) {
+            if (ends[input] < 0 || hin->operations[input].bbid != op.bbid)
+                continue;
+            slacks[input] =
+                std::min(slacks[input], hout->scheds[opid] - ends[input]);
+        }
+    }
+}
+
+int TypeSelector::select() {
+    analyze_slack();
+    vector<int> cur(n_operation, -1);
+    for (int opid = 0; opid < n_operation; opid++)
+        cur[opid] = hout->get_rtid(opid);
+
+    // hot critical ops, by exp_times * saved cycles
+    vector<std::tuple<float, int, int>> fasts;  // (-gain, opid, rtid)
+    for (int opid = 0; opid < n_operation; opid++) {
+        if (slacks[opid] != 0 || cur[opid] == -1) continue;
+        int best = -1;
+        for (int rtid = 0; rtid < hin->n_resource_type; rtid++) {
+            if (!is_compatible(opid, rtid) ||
+                get_latency(rtid) >= get_latency(cur[opid]))
+                continue;
+            const auto &rt = hin->resource_types[rtid];
+            if (best == -1 || rt.latency < get_latency(best) ||
+                (rt.latency == get_latency(best) &&
+                 rt.area < hin->resource_types[best].area))
+                best = rtid;
+        }
+        if (best == -1) continue;
+        const auto &bb = hin->blocks[hin->operations[opid].bbid];
+        float gain =
+            bb.exp_times * (get_latency(cur[opid]) - get_latency(best));
+        fasts.emplace_back(-gain, opid, best);
+    }
+    std::sort(fasts.begin(), fasts.end());
+
+    int area = hout->get_area();
+    int n_moved = 0;
+    for (const auto &it : fasts) {
+        int opid = std::get<1>(it), rtid = std::get<2>(it);
+        if (rinsts[rtid] == 0) {
+            int add = hin->resource_types[rtid].area;
+            if (area + add > hin->area_limit) continue;
+            area += add;
+            rinsts[rtid] = 1;
+        }
+        op2rtid[opid] = cur[opid] = rtid;
+        n_moved++;
+    }
+
+    // ops with slack move to slower types, allocated ones first,
+    // then small ones affordable under the area limit.
+    // A move must lower the busier load of the two types in its block.
+    vector<vector<float>> loads(
+        hin->n_block, vector<float>(hin->n_resource_type, 0));
+    for (int opid = 0; opid < n_operation; opid++)
+        if (cur[opid] != -1 && slacks[opid] >= 0)
+            loads[hin->operations[opid].bbid][cur[opid]] +=
+                get_occupancy(hin->resource_types[cur[opid]]);
+    vector<int> order;
+    for (int opid = 0; opid < n_operation; opid++)
+        if (slacks[opid] > 0 && cur[opid] != -1) order.push_back(opid);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return slacks[a] > slacks[b];
+    });
+    for (auto opid : order) {
+        int rt = cur[opid];
+        auto &load = loads[hin->operations[opid].bbid];
+        float now = load[rt] / std::max(rinsts[rt], 1);
+        int best = -1;
+        for (int rtid = 0; rtid < hin->n_resource_type; rtid++) {
+            if (rtid == rt || !is_compatible(opid, rtid)) continue;
+            int extra = get_latency(rtid) - get_latency(rt);
+            if (extra <= 0 || extra > slacks[opid]) continue;
+            if (rinsts[rtid] == 0 &&
+                area + hin->resource_types[rtid].area > hin->area_limit)
+                continue;
+            int occupancy = get_occupancy(hin->resource_types[rtid]);
+            float after =
+                (load[rtid] + occupancy) / std::max(rinsts[rtid], 1);
+            if (after >= now) continue;
+            auto key = [this](int r) {
+                return std::make_tuple(rinsts[r] == 0, get_latency(r));
+            };
+            if (best == -1 || key(rtid) < key(best)) best = rtid;
+        }
+        if (best == -1) continue;
+        if (rinsts[best] == 0) {
+            area += hin->resource_types[best].area;
+            rinsts[best] = 1;
+        }
+        load[rt] -= get_occupancy(hin->resource_types[rt]);
+        load[best] += get_occupancy(hin->resource_types[best]);
+        op2rtid[opid] = best;
+        n_moved++;
+    }
+    return n_moved;
+}
+
+void TypeSelector::copyout(HLSOutput &hout) const {
+    for (int opid = 0; opid < n_operation; opid++) {
+        int optype = hin->operations[opid].optype;
+        hout.op2rtid[opid] =
+            op2rtid[opid] == hout.ot2rtid[optype] ? -1 : op2rtid[opid];
+    }
+    hout.rinsts = rinsts;
+}
+
+void TypeSelector::print() const {
+    cerr << "Type Selection Result" << endl;
+    cerr << "Op | Slack | Resource Type" << endl;
+    for (int opid = 0; opid < n_operation; opid++)
+        if (op2rtid[opid] != -1)
+            cerr << opid << ": " << slacks[opid] << ", " << op2rtid[opid]
+                 << endl;
+}
+
+}  // namespace hls
@@ -0,0 +1,52 @@
+#ifndef HLS_ALLOCATE_SELECT_H
+#define HLS_ALLOCATE_SELECT_H
+
+#include <vector>
+
+#include "io.h"
+
+using std::vector;
+
+namespace hls {
+
+// Select resource types for ops one by one, on top of an optype allocation.
+// Slack of each op is read from a schedule of hout, then
+// - hot ops on critical paths move to faster compatible types, in order
+//   of exp_times * saved cycles, adding insts under the area limit,
+// - ops with enough slack move to slower types already allocated,
+//   if that balances the load of both types in the block,
+//   freeing the faster insts for critical ops.
+// Results are overrides in op2rtid, to be rescheduled by callers.
+class TypeSelector {
+   private:
+    const HLSInput *hin;
+    const HLSOutput *hout;
+    int n_operation = 0;
+    vector<int> slacks;   // length = n_operation, -1 if not scheduled
+    vector<int> op2rtid;  // length = n_operation, selected types
+    vector<int> rinsts;   // length = n_resource_type
+
+    void analyze_slack();
+    int get_latency(int rtid) const;
+    bool is_compatible(int opid, int rtid) const;
+
+   public:
+    TypeSelector(const HLSInput &hin, const HLSOutput &hout) {
+        this->hin = &hin;
+        this->hout = &hout;
+        this->n_operation = hin.n_operation;
+        slacks.resize(n_operation, -1);
+        op2rtid = hout.op2rtid;
+        rinsts = hout.rinsts;
+    }
+
+    // Returns the number of ops moved to other types.
+    int select();
+    // Write selected types and insts, leaving schedules stale
+    void copyout(HLSOutput &hout) const;
+    void print() const;
+};
+
+}  // namespace hls
+
+#endif
@@ -0,0 +1,134 @@
+#include "util.h"
+
+#include <algorithm>
+#include <string>
+
+#include "reservation.h"
+#include "schedule/list.h"
+
+namespace hls {
+
+int UtilizationReport::analyze() {
+    busy.assign(n_resource_type, vector<int>());
+    weighted.assign(n_resource_type, vector<float>());
+    peaks.assign(hin->n_block, vector<int>(n_resource_type, 0));
+    for (int rtid = 0; rtid < n_resource_type; rtid++) {
+        busy[rtid].resize(hout->rinsts[rtid], 0);
+        weighted[rtid].resize(hout->rinsts[rtid], 0);
+    }
+
+    for (const auto &bb : hin->blocks) {
+        ReservationTable table(*hin, vector<int>(n_resource_type, 0));
+        int start, end;
+        if (!hout->get_block_range(bb.bbid, start, end)) continue;
+        weighted_latency += (end - start) * bb.exp_times;
+
+        for (auto opid : bb.ops) {
+            if (hout->binds[opid] < 0) continue;
+            int rtid = hout->get_rtid(opid);
+            int inst = hout->binds[opid];
+            if (inst >= hout->rinsts[rtid]) {
+                cerr << "Error: op " << opid << " binds to inst " << inst
+                     << " out of " << hout->rinsts[rtid] << endl;
+                return -1;
+            }
+            int occ = table.get_occupancy(rtid);
+            busy[rtid][inst] += occ;
+            weighted[rtid][inst] += occ * bb.exp_times;
+            table.reserve(rtid, hout->scheds[opid] - start);
+        }
+        for (int rtid = 0; rtid < n_resource_type; rtid++)
+            for (int c = 0; c < end - start; c++)
+                peaks[bb.bbid][rtid] =
+                    std::max(peaks[bb.bbid][rtid], table.get_busy(rtid, c));
+    }
+
+    estimate_savings();
+    return 0;
+}
+
+void UtilizationReport::estimate_savings() {
+    savings.assign(n_resource_type, 0);
+    ListScheduler base(*hin, *hout, true);
+    for (int rtid = 0; rtid < n_resource_type; rtid++) {
+        if (hout->rinsts[rtid] == 0) continue;
+        HLSOutput plus = *hout;
+        plus.rinsts[rtid]++;
+        ListScheduler more(*hin, plus, true);
+        for (const auto &bb : hin->blocks) {
+            if (peaks[bb.bbid][rtid] < hout->rinsts[rtid]) continue;
+            map<int, int> res;
+            int len = base.schedule_block(bb.bbid, res);
+            res.clear();
+            int len_more = more.schedule_block(bb.bbid, res);
+            if (len < 0 || len_more < 0) continue;
+            savings[rtid] += std::max(0, len - len_more) * bb.exp_times;
+        }
+    }
+}
+
+float UtilizationReport::get_utilization(int rtid, int inst) const {
+    if (weighted_latency <= 0) return 0;
+    return weighted[rtid][inst] / weighted_latency;
+}
+
+void UtilizationReport::print_json(std::ostream &out) const {
+    out << "{" << endl;
+    out << "  \"weighted_latency\": " << weighted_latency << "," << endl;
+    out << "  \"resources\": [";
+    bool first = true;
+    for (int rtid = 0; rtid < n_resource_type; rtid++) {
+        if (hout->rinsts[rtid] == 0) continue;
+        out << (first ? "" : ",") << endl;
+        first = false;
+        out << "    {\"rtid\": " << rtid
+            << ", \"insts\": " << hout->rinsts[rtid]
+            << ", \"saving\": " << savings[rtid] << "," << endl;
+        out << "     \"instances\": [";
+        for (int inst = 0; inst < hout->rinsts[rtid]; inst++)
+            out << (inst ? ", " : "") << "{\"inst\": " << inst
+                << ", \"busy\": " << busy[rtid][inst]
+                << ", \"utilization\": " << get_utilization(rtid, inst)
+                << "}";
+        out << "]," << endl;
+        out << "     \"peaks\": [";
+        for (int bbid = 0; bbid < hin->n_block; bbid++)
+            out << (bbid ? ", " : "") << peaks[bbid][rtid];
+        out << "]}";
+    }
+    out << endl << "  ]" << endl << "}" << endl;
+}
+
+void UtilizationReport::print_gantt(std::ostream &out, int max_width) const {
+    for (const auto &bb : hin->blocks) {
+        int start, end;
+        if (!hout->get_block_range(bb.bbid, start, end)) continue;
+        int width = std::min(end - start, max_width);
+        out << "block " << bb.bbid << " [" << start << ", " << end
+            << ") x " << bb.exp_times << endl;
+
+        // '#' for the first cycle of an op, '=' for the rest
+        vector<vector<std::string>> rows(n_resource_type);
+        for (int rtid = 0; rtid < n_resource_type; rtid++)
+            rows[rtid].assign(hout->rinsts[rtid], std::string(width, '.'));
+        for (auto opid : bb.ops) {
+            if (hout->binds[opid] < 0) continue;
+            int rtid = hout->get_rtid(opid);
+            int occ = get_occupancy(hin->resource_types[rtid]);
+            auto &row = rows[rtid][hout->binds[opid]];
+            for (int c = 0; c < occ; c++) {
+                int col = hout->scheds[opid] - start + c;
+                if (col < width) row[col] = c ? '=' : '#';
+            }
+        }
+        for (int rtid = 0; rtid < n_resource_type; rtid++) {
+            if (peaks[bb.bbid][rtid] == 0) continue;
+            for (int inst = 0; inst < hout->rinsts[rtid]; inst++)
+                out << "  r" << rtid << "." << inst << " |"
+                    << rows[rtid][inst] << (width < end - start ? "..." : "|")
+                    << endl;
+        }
+    }
+}
+
+}  // namespace hls
@@ -0,0 +1,51 @@
+#ifndef HLS_ANALYSIS_UTIL_H
+#define HLS_ANALYSIS_UTIL_H
+
+#include <ostream>
+#include <vector>
+
+#include "io.h"
+
+using std::vector;
+
+namespace hls {
+
+// Utilization and bottleneck report of a bound schedule
+// Busy cycles of each inst are weighted by exp_times of their blocks, and
+// utilization is over the weighted latency. Sensitivity of a resource type
+// is the weighted latency that one more inst saves in blocks saturating it,
+// estimated by list scheduling those blocks with and without it.
+class UtilizationReport {
+   private:
+    const HLSInput *hin;
+    const HLSOutput *hout;
+    int n_resource_type;
+
+    void estimate_savings();
+
+   public:
+    float weighted_latency = 0;
+    vector<vector<int>> busy;        // rtid -> inst -> busy cycles
+    vector<vector<float>> weighted;  // rtid -> inst -> weighted busy cycles
+    vector<vector<int>> peaks;       // bbid -> rtid -> peak concurrency
+    vector<float> savings;           // rtid -> weighted latency saved
+
+    UtilizationReport(const HLSInput &hin, const HLSOutput &hout) {
+        this->hin = &hin;
+        this->hout = &hout;
+        this->n_resource_type = hin.n_resource_type;
+    }
+
+    // Returns 0 on success, -1 on errors.
+    int analyze();
+
+    float get_utilization(int rtid, int inst) const;
+
+    void print_json(std::ostream &out) const;
+    // One chart per block: a row per inst, a column per cycle
+    void print_gantt(std::ostream &out, int max_width = 100) const;
+};
+
+}  // namespace hls
+
+#endif
@@ -0,0 +1,293 @@
+#include "validate.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "reservation.h"
+
+namespace hls {
+
+const char *get_violation_name(ViolationKind kind) {
+    switch (kind) {
+        case VIOL_COMPAT:
+            return "incompatible type";
+        case VIOL_OP:
+            return "unscheduled or unbound op";
+        case VIOL_DEPENDENCY:
+            return "dependency";
+        case VIOL_OVERLAP:
+            return "inst overlap";
+        case VIOL_BLOCK:
+            return "block overlap";
+        case VIOL_AREA:
+            return "area";
+        default:
+            return "unknown";
+    }
+}
+
+Validator::Validator(const HLSInput &hin, const HLSOutput &hout) {
+    this->hin = &hin;
+    this->hout = &hout;
+    users.resize(hin.n_operation);
+    far_users.resize(hin.n_block);
+    for (const auto &op : hin.operations) {
+        if (hin.get_opcate(op.opid) == OP_PHI) continue;
+        for (auto in : op.inputs) {
+            if (in < 0) continue;
+            int pbb = hin.operations[in].bbid;
+            if (pbb == op.bbid) {
+                users[in].push_back(op.opid);
+            } else {
+                far_users[pbb].push_back(op.opid);
+                far_users[op.bbid].push_back(op.opid);
+            }
+        }
+    }
+    for (auto &ops : far_users) {
+        std::sort(ops.begin(), ops.end());
+        ops.erase(std::unique(ops.begin(), ops.end()), ops.end());
+    }
+    find_carried();
+}
+
+// A value of block a may flow back to block b if a reaches the source of
+// a back edge and its target reaches b, both without taking back edges.
+void Validator::find_carried() {
+    int n_block = hin->n_block;
+    vector<vector<int>> nexts(n_block);
+    vector<pair<int, int>> back_edges;
+
+    // DFS, where an edge to a block on the stack is a back edge
+    // from entries first, then from blocks left unreachable
+    vector<int> roots;
+    for (int bbid = 0; bbid < n_block; bbid++)
+        if (hin->blocks[bbid].n_pred == 0) roots.push_back(bbid);
+    for (int bbid = 0; bbid < n_block; bbid++) roots.push_back(bbid);
+    vector<int> state(n_block, 0);  // 0 unvisited, 1 on stack, 2 done
+    for (auto root : roots) {
+        if (state[root] != 0) continue;
+        vector<pair<int, int>> stack;  // (bbid, next succ)
+        stack.push_back(std::make_pair(root, 0));
+        state[root] = 1;
+        while (!stack.empty()) {
+            auto &top = stack.back();
+            int bbid = top.first;
+            const auto &succs = hin->blocks[bbid].succs;
+            if (top.second < succs.size()) {
+                int succ = succs[top.second++];
+                if (state[succ] == 1) {
+                    back_edges.push_back(std::make_pair(bbid, succ));
+                    continue;
+                }
+                nexts[bbid].push_back(succ);
+                if (state[succ] == 0) {
+                    state[succ] = 1;
+                    stack.push_back(std::make_pair(succ, 0));
+                }
+            } else {
+                state[bbid] = 2;
+                stack.pop_back();
+            }
+        }
+    }
+
+    // reach[a][b]: b is reachable from a without back edges
+    vector<vector<bool>> reach(n_block, vector<bool>(n_block, false));
+    for (int bbid = 0; bbid < n_block; bbid++) {
+        vector<int> todo = {bbid};
+        reach[bbid][bbid] = true;
+        while (!todo.empty()) {
+            int cur = todo.back();
+            todo.pop_back();
+            for (auto next : nexts[cur]) {
+                if (reach[bbid][next]) continue;
+                reach[bbid][next] = true;
+                todo.push_back(next);
+            }
+        }
+    }
+
+    carried.assign(n_block, vector<bool>(n_block, false));
+    for (const auto &edge : back_edges)
+        for (int a = 0; a < n_block; a++) {
+            if (!reach[a][edge.first]) continue;
+            for (int b = 0; b < n_block; b++)
+                if (reach[edge.second][b]) carried[a][b] = true;
+        }
+}
+
+// Returns true if the op is unscheduled, unbound or out of rinsts
+bool Validator::check_op(int opid) const {
+    auto opcate = hin->get_opcate(opid);
+    if (hin->need_schedule(opcate) && hout->scheds[opid] < 0) return true;
+    if (!hin->need_bind(opcate)) return false;
+    int rtid = hout->get_rtid(opid);
+    int inst = hout->binds[opid];
+    return rtid == -1 || inst < 0 || inst >= hout->rinsts[rtid];
+}
+
+// Returns num of inputs not ready when the op starts. Inputs from other
+// blocks are checked on block ranges, so update blocks first.
+int Validator::check_inputs(int opid) const {
+    const auto &op = hin->operations[opid];
+    auto opcate = hin->get_opcate(opid);
+    if (!hin->need_schedule(opcate) || hout->scheds[opid] < 0) return 0;
+    int n_bad = 0;
+    for (auto in : op.inputs) {
+        if (in < 0 || !hin->need_schedule(hin->get_opcate(in))) continue;
+        int pbb = hin->operations[in].bbid;
+        if (pbb == op.bbid) {
+            int ready = hout->scheds[in] + hout->get_latency(in) + 1;
+            if (hout->scheds[opid] < ready) n_bad++;
+        } else if (opcate != OP_PHI && !carried[pbb][op.bbid]) {
+            if (ends[pbb] == -1 || starts[op.bbid] == -1) continue;
+            if (ends[pbb] > starts[op.bbid]) n_bad++;
+        }
+    }
+    return n_bad;
+}
+
+// Take the cells of the op's inst, counting overlaps
+void Validator::place(int opid) {
+    int inst = hout->binds[opid];
+    int cycle = hout->scheds[opid];
+    if (inst < 0 || cycle < 0) return;
+    int rtid = hout->get_rtid(opid);
+    if (rtid == -1) return;
+
+    auto &insts = cells[rtid];
+    if (insts.size() <= inst) insts.resize(inst + 1);
+    auto &cycles = insts[inst];
+    int end = cycle + get_occupancy(hin->resource_types[rtid]);
+    if (cycles.size() < end) cycles.resize(end, 0);
+    for (int c = cycle; c < end; c++)
+        if (cycles[c]++ > 0) counts[VIOL_OVERLAP]++;
+    placed_cycle[opid] = cycle;
+    placed_inst[opid] = inst;
+}
+
+void Validator::unplace(int opid) {
+    int inst = placed_inst[opid];
+    int cycle = placed_cycle[opid];
+    if (inst < 0) return;
+    int rtid = hout->get_rtid(opid);
+    auto &cycles = cells[rtid][inst];
+    int end = cycle + get_occupancy(hin->resource_types[rtid]);
+    for (int c = cycle; c < end; c++)
+        if (--cycles[c] > 0) counts[VIOL_OVERLAP]--;
+    placed_cycle[opid] = placed_inst[opid] = -1;
+}
+
+void Validator::update_op(int opid) {
+    counts[VIOL_OP] -= op_bad[opid];
+    op_bad[opid] = check_op(opid);
+    counts[VIOL_OP] += op_bad[opid];
+    counts[VIOL_DEPENDENCY] -= dep_bad[opid];
+    dep_bad[opid] = check_inputs(opid);
+    counts[VIOL_DEPENDENCY] += dep_bad[opid];
+}
+
+void Validator::update_block(int bbid) {
+    int start, end;
+    if (hout->get_block_range(bbid, start, end)) {
+        starts[bbid] = start;
+        ends[bbid] = end;
+    } else {
+        starts[bbid] = ends[bbid] = -1;
+    }
+}
+
+// Blocks must not share cycles
+void Validator::check_blocks() {
+    vector<pair<int, int>> ranges;
+    for (int bbid = 0; bbid < hin->n_block; bbid++)
+        if (starts[bbid] != -1)
+            ranges.push_back(std::make_pair(starts[bbid], ends[bbid]));
+    std::sort(ranges.begin(), ranges.end());
+    counts[VIOL_BLOCK] = 0;
+    for (int i = 1; i < ranges.size(); i++)
+        if (ranges[i].first < ranges[i - 1].second) counts[VIOL_BLOCK]++;
+}
+
+void Validator::check_area() {
+    counts[VIOL_AREA] = hout->get_area() > hin->area_limit;
+}
+
+int Validator::check() {
+    int n_operation = hin->n_operation;
+    counts.assign(N_VIOL_KIND, 0);
+    placed_cycle.assign(n_operation, -1);
+    placed_inst.assign(n_operation, -1);
+    cells.assign(hin->n_resource_type, vector<vector<int>>());
+    op_bad.assign(n_operation, false);
+    dep_bad.assign(n_operation, 0);
+    starts.assign(hin->n_block, -1);
+    ends.assign(hin->n_block, -1);
+
+    auto is_compatible = [this](int ot, int rtid) {
+        const auto &comp = hin->resource_types[rtid].comp_ops;
+        return std::find(comp.begin(), comp.end(), ot) != comp.end();
+    };
+    for (int ot = 0; ot < hin->n_op_type; ot++) {
+        if (!hin->need_schedule(hin->op_types[ot])) continue;
+        int rtid = hout->ot2rtid[ot];
+        if (rtid == -1) continue;  // reported on its ops
+        if (!is_compatible(ot, rtid)) counts[VIOL_COMPAT]++;
+    }
+    for (int opid = 0; opid < n_operation; opid++) {
+        int rtid = hout->op2rtid[opid];
+        if (rtid == -1) continue;
+        if (!is_compatible(hin->operations[opid].optype, rtid))
+            counts[VIOL_COMPAT]++;
+    }
+    for (int bbid = 0; bbid < hin->n_block; bbid++) update_block(bbid);
+    for (int opid = 0; opid < n_operation; opid++) {
+        update_op(opid);
+        place(opid);
+    }
+    check_blocks();
+    check_area();
+    return std::accumulate(counts.begin(), counts.end(), 0);
+}
+
+int Validator::recheck(const vector<int> &opids) {
+    if (counts.empty()) return check();
+    vector<int> ops, bbids;
+    for (auto opid : opids) {
+        ops.push_back(opid);
+        for (auto user : users[opid]) ops.push_back(user);
+        bbids.push_back(hin->operations[opid].bbid);
+    }
+    std::sort(bbids.begin(), bbids.end());
+    bbids.erase(std::unique(bbids.begin(), bbids.end()), bbids.end());
+    for (auto bbid : bbids)
+        for (auto user : far_users[bbid]) ops.push_back(user);
+    std::sort(ops.begin(), ops.end());
+    ops.erase(std::unique(ops.begin(), ops.end()), ops.end());
+
+    for (auto opid : opids) {
+        unplace(opid);
+        place(opid);
+    }
+    for (auto bbid : bbids) update_block(bbid);
+    for (auto opid : ops) update_op(opid);
+    check_blocks();
+    check_area();
+    return std::accumulate(counts.begin(), counts.end(), 0);
+}
+
+bool Validator::is_valid() const {
+    return std::accumulate(counts.begin(), counts.end(), 0) == 0;
+}
+
+void Validator::print() const {
+    cerr << "Validation Result: " << (is_valid() ? "valid" : "invalid")
+         << endl;
+    for (int kind = 0; kind < N_VIOL_KIND; kind++)
+        if (counts[kind] > 0)
+            cerr << "  " << get_violation_name((ViolationKind)kind) << ": "
+                 << counts[kind] << endl;
+}
+
+}  // namespace hls
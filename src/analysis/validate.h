@@ -0,0 +1,78 @@
+#ifndef HLS_ANALYSIS_VALIDATE_H
+#define HLS_ANALYSIS_VALIDATE_H
+
+#include <vector>
+
+#include "io.h"
+
+using std::vector;
+
+namespace hls {
+
+enum ViolationKind {
+    VIOL_COMPAT,      // op or op type on an incompatible resource type
+    VIOL_OP,          // op unscheduled, unbound, or bound out of rinsts
+    VIOL_DEPENDENCY,  // op starts before an input is ready
+    VIOL_OVERLAP,     // two ops take one inst in one cycle
+    VIOL_BLOCK,       // cycle ranges of blocks overlap
+    VIOL_AREA,        // area limit exceeded
+    N_VIOL_KIND
+};
+
+const char *get_violation_name(ViolationKind kind);
+
+// Legality checker of a schedule and binding, viewing hout.
+// Chaining is not allowed, so an op starts after its inputs in the block
+// are ready. Non-phi inputs from other blocks need their block finished
+// before the reading block starts, unless the value may flow there through
+// a back edge of the CFG. Bound ops must take their insts alone, pipelined
+// ones for a cycle and others until the result is ready, which also keeps
+// per-cycle usage within rinsts.
+// Finding blocks values may flow back to is quadratic in blocks, once more
+// for each back edge, and runs once on construction. A full check then runs
+// in time linear to ops and busy cycles. After editing scheds or binds of
+// some ops, recheck only those ops, their users in block, their insts,
+// their blocks and the ops reading across those blocks.
+class Validator {
+   private:
+    const HLSInput *hin;
+    const HLSOutput *hout;
+    vector<vector<int>> users;         // opid -> ops reading it in block
+    vector<vector<int>> far_users;     // bbid -> ops reading across it
+    vector<vector<bool>> carried;      // bbid -> bbid a value may flow back to
+    vector<int> placed_cycle;          // cycle an op is placed at, or -1
+    vector<int> placed_inst;           // inst an op is placed on, or -1
+    vector<vector<vector<int>>> cells;  // rtid -> inst -> cycle -> num of ops
+    vector<bool> op_bad;
+    vector<int> dep_bad;      // opid -> num of inputs not ready in time
+    vector<int> starts, ends;  // cycle range of each block, -1 if empty
+    vector<int> counts;        // kind -> num of violations
+
+    void find_carried();
+    bool check_op(int opid) const;
+    int check_inputs(int opid) const;
+    void place(int opid);
+    void unplace(int opid);
+    void update_op(int opid);
+    void update_block(int bbid);
+    void check_blocks();
+    void check_area();
+
+   public:
+    Validator(const HLSInput &hin, const HLSOutput &hout);
+
+    // Check all, returns total num of violations.
+    int check();
+
+    // Check again after editing scheds or binds of these ops,
+    // returns total num of violations.
+    int recheck(const vector<int> &opids);
+
+    int get_violations(ViolationKind kind) const { return counts[kind]; }
+    bool is_valid() const;
+    void print() const;
+};
+
+}  // namespace hls
+
+#endif
@@ -12,22 +12,17 @@ bool BaseBinder::check_conflict(int opid1, int opid2) {
 
     // Operations of the same type?
     if (op1.optype != op2.optype) return false;
+    if (hout->get_rtid(opid1) != hout->get_rtid(opid2)) return false;
 
     // Operation needs to be binded?
     if (!hin->need_bind(hin->get_opcate(opid1))) return false;
 
     // Execution overlaps?
-    int optype = op1.optype;
-    int rstype = hout->ot2rtid[optype];
+    int rstype = hout->get_rtid(opid1);
     const ResourceType &rs = hin->resource_types[rstype];
     int early = std::min(hout->scheds[opid1], hout->scheds[opid2]);
     int late = std::max(hout->scheds[opid1], hout->scheds[opid2]);
-    if (rs.is_pipelined) {
-        if (early == late) return true;
-    } else {
-        if (late - early < rs.latency + 1) return true;
-    }
-    return false;
+    return late - early < get_occupancy(rs);
 }
 
 // Greedily add a color for op, without conflict with its colored neighboors.
@@ -76,21 +71,24 @@ int BaseBinder::bind() {
         if (hin->need_bind(hin->get_opcate(opid))) conf_graph.add_color(opid);
     }
 
-    // write color to binds
+    // write color to binds, each (optype, rtid) group colored apart
+    map<pair<int, int>, int> group_base;  // (optype, rtid) -> colors used
+    for (int i = 0; i < n_operation; i++) {
+        if (!hin->need_bind(hin->get_opcate(i))) continue;
+        auto key = std::make_pair(hin->operations[i].optype, hout->get_rtid(i));
+        group_base[key] = std::max(group_base[key], conf_graph.colors[i] + 1);
+    }
     vector<int> cnt_rtype(hin->n_resource_type, 0);
-    vector<int> op2rbase(n_op_type, 0);  // optype -> smallest resource id
-    for (int optype = 0; optype < n_op_type; optype++) {
-        int rtid = hout->ot2rtid[optype];
-        if (rtid != -1) {
-            op2rbase[optype] = cnt_rtype[rtid];
-            cnt_rtype[rtid] += hout->insts[optype];
-        }
+    for (auto &group : group_base) {
+        int n_color = group.second;
+        group.second = cnt_rtype[group.first.second];
+        cnt_rtype[group.first.second] += n_color;
     }
     for (int i = 0; i < n_operation; i++) {
         if (hin->need_bind(hin->get_opcate(i))) {
-            int color = conf_graph.colors[i];
-            int optype = hin->operations[i].optype;
-            binds[i] = op2rbase[optype] + color;
+            auto key =
+                std::make_pair(hin->operations[i].optype, hout->get_rtid(i));
+            binds[i] = group_base[key] + conf_graph.colors[i];
         } else {
             binds[i] = -1;
         }
@@ -99,35 +97,31 @@ int BaseBinder::bind() {
     return 0;
 }
 
+// Write binding result, and set num of insts to what binding really uses
 void BaseBinder::copyout(HLSOutput &hout) {
+    std::fill(hout.rinsts.begin(), hout.rinsts.end(), 0);
     for (int i = 0; i < n_operation; i++) {
         hout.binds[i] = binds[i];
+        if (binds[i] == -1) continue;
+        int rtid = hout.get_rtid(i);
+        hout.rinsts[rtid] = std::max(hout.rinsts[rtid], binds[i] + 1);
     }
 }
 
 bool RBinder::check_conflict(int opid1, int opid2) {
-    const Operation &op1 = hin->operations[opid1];
-    const Operation &op2 = hin->operations[opid2];
-
     // Operation needs to be binded?
     if (!hin->need_bind(hin->get_opcate(opid1))) return false;
     if (!hin->need_bind(hin->get_opcate(opid2))) return false;
 
     // Operation shares resource type?
-    if (hout->ot2rtid[op1.optype] != hout->ot2rtid[op2.optype]) return false;
+    int rstype = hout->get_rtid(opid1);
+    if (rstype != hout->get_rtid(opid2)) return false;
 
     // Execution overlaps?
-    int optype = op1.optype;
-    int rstype = hout->ot2rtid[optype];
     const ResourceType &rs = hin->resource_types[rstype];
     int early = std::min(hout->scheds[opid1], hout->scheds[opid2]);
     int late = std::max(hout->scheds[opid1], hout->scheds[opid2]);
-    if (rs.is_pipelined) {
-        if (early == late) return true;
-    } else {
-        if (late - early < rs.latency + 1) return true;
-    }
-    return false;
+    return late - early < get_occupancy(rs);
 }
 
 int RBinder::bind() {
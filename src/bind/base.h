@@ -6,6 +6,7 @@
 
 #include "io.h"
 #include "graph.h"
+#include "reservation.h"
 
 using std::pair;
 using std::vector;
@@ -0,0 +1,183 @@
+#include "mux.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace hls {
+
+int InstPorts::get_fan_in() const {
+    int res = 0;
+    for (const auto &port : srcs) res += port.size();
+    return res;
+}
+
+int InstPorts::get_mux_inputs() const {
+    int res = 0;
+    for (const auto &port : srcs)
+        if (port.size() > 1) res += port.size();
+    return res;
+}
+
+// Hungarian algorithm with potentials, O(n^2 m)
+vector<int> min_cost_assign(const vector<vector<long long>> &cost_) {
+    const long long INF = std::numeric_limits<long long>::max() / 4;
+    int n = cost_.size();
+    int m = n ? cost_[0].size() : 0;
+
+    // shift costs to be non-negative
+    long long low = 0;
+    for (const auto &row : cost_)
+        for (auto c : row) low = std::min(low, c);
+    vector<vector<long long>> cost(cost_);
+    for (auto &row : cost)
+        for (auto &c : row) c -= low;
+    vector<long long> u(n + 1, 0), v(m + 1, 0);
+    vector<int> p(m + 1, 0), way(m + 1, 0);  // p[col] = row, 1-indexed
+
+    for (int i = 1; i <= n; i++) {
+        p[0] = i;
+        int j0 = 0;
+        vector<long long> minv(m + 1, INF);
+        vector<bool> used(m + 1, false);
+        do {
+            used[j0] = true;
+            int i0 = p[j0], j1 = 0;
+            long long delta = INF;
+            for (int j = 1; j <= m; j++) {
+                if (used[j]) continue;
+                long long cur = cost[i0 - 1][j - 1] - u[i0] - v[j];
+                if (cur < minv[j]) {
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= m; j++) {
+                if (used[j]) {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+        do {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0);
+    }
+
+    vector<int> res(n, -1);
+    for (int j = 1; j <= m; j++)
+        if (p[j]) res[p[j] - 1] = j - 1;
+    return res;
+}
+
+// A new source on a used port adds a mux input, or two if it turns a wire
+// into a mux. A destination shared with the instance saves one input on
+// the consumer.
+int MuxBinder::get_cost(int opid, const InstPorts &p) const {
+    const auto &ins = hin->operations[opid].inputs;
+    auto added = [&p](int port, int src) {
+        if (src < 0 || port >= (int)p.srcs.size()) return 0;
+        const auto &port_srcs = p.srcs[port];
+        if (port_srcs.empty() || port_srcs.count(src)) return 0;
+        return port_srcs.size() == 1 ? 2 : 1;
+    };
+
+    int res = 0;
+    for (int k = 0; k < (int)ins.size(); k++) res += added(k, ins[k]);
+    for (auto u : users[opid]) res -= p.dests.count(u);
+    return res;
+}
+
+void MuxBinder::connect(int opid, InstPorts &p) {
+    const auto &ins = hin->operations[opid].inputs;
+    if (p.srcs.size() < ins.size()) p.srcs.resize(ins.size());
+    for (int k = 0; k < (int)ins.size(); k++)
+        if (ins[k] >= 0) p.srcs[k].insert(ins[k]);
+    for (auto u : users[opid]) p.dests.insert(u);
+}
+
+void MuxBinder::bind_group_mux(int rtid, const vector<pair<int, int>> &ops,
+                               int n_inst) {
+    int occupancy = get_occupancy(hin->resource_types[rtid]);
+    auto &inst_ports = ports[rtid];
+    inst_ports.assign(n_inst, InstPorts());
+    vector<int> free_at(n_inst, std::numeric_limits<int>::min());
+
+    for (int i = 0, j; i < (int)ops.size(); i = j) {
+        // ops starting at the same cycle
+        int start = ops[i].first;
+        for (j = i; j < (int)ops.size() && ops[j].first == start; j++) {
+        }
+        vector<int> free_insts;
+        for (int inst = 0; inst < n_inst; inst++)
+            if (free_at[inst] <= start) free_insts.push_back(inst);
+
+        // lower inst ids break ties, never outweighing a mux input
+        long long scale = (long long)(j - i) * free_insts.size() + 1;
+        vector<vector<long long>> cost(j - i,
+                                       vector<long long>(free_insts.size()));
+        for (int s = i; s < j; s++) {
+            for (int f = 0; f < (int)free_insts.size(); f++) {
+                int c = get_cost(ops[s].second, inst_ports[free_insts[f]]);
+                cost[s - i][f] = c * scale + f;
+            }
+        }
+
+        auto assign = min_cost_assign(cost);
+        for (int s = i; s < j; s++) {
+            int opid = ops[s].second;
+            int f = assign[s - i];
+            int inst = free_insts[f];
+            binds[opid] = inst;
+            free_at[inst] = start + occupancy;
+            connect(opid, inst_ports[inst]);
+        }
+    }
+}
+
+int MuxBinder::bind() {
+    vector<vector<pair<int, int>>> groups;
+    if (group_ops(groups) < 0) return -1;
+
+    ports.assign(n_resource_type, vector<InstPorts>());
+    for (int rtid = 0; rtid < n_resource_type; rtid++) {
+        // left edge gives the minimum num of insts and sorts ops
+        int n_inst = bind_group(rtid, groups[rtid]);
+        bind_group_mux(rtid, groups[rtid], n_inst);
+    }
+    return 0;
+}
+
+int MuxBinder::get_mux_inputs() const {
+    int res = 0;
+    for (const auto &inst_ports : ports)
+        for (const auto &p : inst_ports) res += p.get_mux_inputs();
+    return res;
+}
+
+// Display mux fan-in of each instance
+void MuxBinder::print(bool verbose) const {
+    cerr << "Mux Binding Result" << endl;
+    cerr << "Total mux inputs: " << get_mux_inputs() << endl;
+    if (!verbose) return;
+    cerr << "Resource Type | Instance | fan-in (per port)" << endl;
+    for (int rtid = 0; rtid < n_resource_type; rtid++) {
+        for (int inst = 0; inst < (int)ports[rtid].size(); inst++) {
+            const auto &p = ports[rtid][inst];
+            cerr << rtid << ", " << inst << ": " << p.get_fan_in() << " (";
+            for (int k = 0; k < (int)p.srcs.size(); k++)
+                cerr << (k ? " " : "") << p.srcs[k].size();
+            cerr << ")" << endl;
+        }
+    }
+}
+
+};  // namespace hls
@@ -0,0 +1,68 @@
+#ifndef HLS_BIND_MUX_H
+#define HLS_BIND_MUX_H
+
+#include <set>
+#include <vector>
+
+#include "io.h"
+#include "sweep.h"
+
+using std::set;
+using std::vector;
+
+namespace hls {
+
+// Interconnect of a resource instance
+class InstPorts {
+   public:
+    vector<set<int>> srcs;  // source ops of each input port
+    set<int> dests;         // ops consuming results of the instance
+
+    int get_fan_in() const;     // sum of sources over all ports
+    int get_mux_inputs() const;  // sources of ports needing a mux
+};
+
+// Binding operations to resource instances with interconnect awareness
+// Keeps the optimal number of instances of left edge binding, but in each
+// cycle matches starting ops to free instances with maximum weighted
+// bipartite matching. Sharing an operand source or a result destination
+// with ops already on the instance saves a mux input, while a new source
+// on a used port adds one. Inputs keep their order, as the output gives no
+// way to swap them.
+class MuxBinder : public SweepBinder {
+   protected:
+    vector<vector<int>> users;         // opid -> ops using its result
+    vector<vector<InstPorts>> ports;   // rtid -> instance -> ports
+
+    // Bind ops of one resource type, given as sorted (start cycle, opid)
+    void bind_group_mux(int rtid, const vector<pair<int, int>> &ops,
+                        int n_inst);
+
+    // Cost of binding op onto an instance, lower is better.
+    int get_cost(int opid, const InstPorts &p) const;
+
+    void connect(int opid, InstPorts &p);
+
+   public:
+    MuxBinder(const HLSInput &hin, const HLSOutput &hout)
+        : SweepBinder(hin, hout) {
+        users.resize(n_operation);
+        for (const auto &op : hin.operations)
+            for (auto in : op.inputs)
+                if (in >= 0) users[in].push_back(op.opid);
+    }
+
+    // Returns 0 on success, -1 on errors.
+    int bind();
+
+    int get_mux_inputs() const;
+    void print(bool verbose = false) const;  // report mux fan-in
+};
+
+// Minimum cost assignment of rows to distinct columns, rows <= columns.
+// Returns the column assigned to each row.
+vector<int> min_cost_assign(const vector<vector<long long>> &cost);
+
+};  // namespace hls
+
+#endif
@@ -0,0 +1,207 @@
+#include "reg.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <queue>
+
+using std::greater;
+using std::pair;
+using std::priority_queue;
+
+namespace hls {
+
+void RegisterBinder::add_use(int opid, int cycle, int bbid,
+                             vector<int> &first_hold, vector<int> &last_use,
+                             vector<bool> &visiting) const {
+    const auto &op = hin->operations[opid];
+    auto opcate = hin->get_opcate(opid);
+
+    // phi nodes hold no value themselves, read their inputs instead
+    if (opcate == OP_PHI) {
+        if (visiting[opid]) return;
+        visiting[opid] = true;
+        for (auto in : op.inputs)
+            if (in >= 0)
+                add_use(in, cycle, bbid, first_hold, last_use, visiting);
+        visiting[opid] = false;
+        return;
+    }
+
+    // only computed and loaded values live in registers
+    if (!(hin->need_bind(opcate) || opcate == OP_LOAD)) return;
+    if (hout->scheds[opid] < 0) return;
+
+    // read before written: it's read through a back edge in the next
+    // iteration, so hold it until its block exits, and from the start of
+    // the reading block on, which covers the loop body in between
+    int def = hout->scheds[opid] + hout->get_latency(opid) + 1;
+    if (cycle < def) {
+        first_hold[opid] = std::min(first_hold[opid], block_start[bbid]);
+        cycle = block_end[op.bbid];
+    }
+    last_use[opid] = std::max(last_use[opid], cycle);
+
+    // read in a loop it's defined out of: the loop may run again, so hold
+    // it over the whole loop
+    for (int l = 0; l < loops.size(); l++) {
+        if (!loops[l][bbid] || loops[l][op.bbid]) continue;
+        first_hold[opid] = std::min(first_hold[opid], loop_start[l]);
+        last_use[opid] = std::max(last_use[opid], loop_end[l]);
+    }
+}
+
+// Find the natural loop of each back edge in a DFS from the entry, and the
+// cycles its blocks span
+void RegisterBinder::find_loops() {
+    int n_block = hin->n_block;
+    loops.clear();
+    loop_start.clear();
+    loop_end.clear();
+    int entry = -1;
+    for (int bbid = 0; bbid < n_block && entry == -1; bbid++)
+        if (hin->blocks[bbid].n_pred == 0) entry = bbid;
+    if (entry == -1) return;
+
+    vector<pair<int, int>> back_edges;  // (tail, head)
+    vector<int> state(n_block, 0);      // 0 unvisited, 1 on stack, 2 done
+    vector<pair<int, int>> stack;       // (bbid, next succ)
+    stack.push_back(std::make_pair(entry, 0));
+    state[entry] = 1;
+    while (!stack.empty()) {
+        auto &top = stack.back();
+        const auto &succs = hin->blocks[top.first].succs;
+        if (top.second < succs.size()) {
+            int from = top.first;
+            int succ = succs[top.second++];
+            if (state[succ] == 1) {
+                back_edges.push_back(std::make_pair(from, succ));
+            } else if (state[succ] == 0) {
+                state[succ] = 1;
+                stack.push_back(std::make_pair(succ, 0));
+            }
+        } else {
+            state[top.first] = 2;
+            stack.pop_back();
+        }
+    }
+
+    for (const auto &edge : back_edges) {
+        // blocks reaching the tail without passing the head
+        vector<bool> body(n_block, false);
+        vector<int> work = {edge.first};
+        body[edge.second] = body[edge.first] = true;
+        while (!work.empty()) {
+            int bbid = work.back();
+            work.pop_back();
+            if (bbid == edge.second) continue;
+            for (auto pred : hin->blocks[bbid].preds) {
+                if (body[pred] || state[pred] == 0) continue;
+                body[pred] = true;
+                work.push_back(pred);
+            }
+        }
+        int start = INT_MAX, end = -1;
+        for (int bbid = 0; bbid < n_block; bbid++) {
+            if (!body[bbid] || block_start[bbid] < 0) continue;
+            start = std::min(start, block_start[bbid]);
+            end = std::max(end, block_end[bbid]);
+        }
+        if (end < 0) continue;
+        loops.push_back(body);
+        loop_start.push_back(start);
+        loop_end.push_back(end);
+    }
+}
+
+int RegisterBinder::analyze() {
+    block_start.assign(hin->n_block, -1);
+    block_end.assign(hin->n_block, -1);
+    for (int bbid = 0; bbid < hin->n_block; bbid++) {
+        int start, end;
+        if (hout->get_block_range(bbid, start, end)) {
+            block_start[bbid] = start;
+            block_end[bbid] = end - 1;
+        }
+    }
+    find_loops();
+
+    // find the last cycle each value is read
+    vector<int> last_use(n_operation, -1);
+    vector<int> first_hold(n_operation, INT_MAX);
+    vector<bool> visiting(n_operation, false);
+    for (const auto &op : hin->operations) {
+        auto opcate = hin->get_opcate(op.opid);
+        int cycle;
+        if (hin->need_schedule(opcate))
+            cycle = hout->scheds[op.opid];
+        else if (opcate == OP_BRANCH)  // condition is read on block exit
+            cycle = block_end[op.bbid];
+        else
+            continue;  // phi is resolved by its readers
+        if (cycle < 0) continue;
+
+        for (auto in : op.inputs)
+            if (in >= 0)
+                add_use(in, cycle, op.bbid, first_hold, last_use, visiting);
+    }
+
+    lifetimes.clear();
+    for (int opid = 0; opid < n_operation; opid++) {
+        if (last_use[opid] < 0) continue;
+        Lifetime lt;
+        lt.opid = opid;
+        lt.start = hout->scheds[opid] + hout->get_latency(opid) + 1;
+        lt.start = std::min(lt.start, first_hold[opid]);
+        lt.end = last_use[opid];
+        if (lt.end >= lt.start) lifetimes.push_back(lt);
+    }
+    return 0;
+}
+
+int RegisterBinder::bind() {
+    std::sort(lifetimes.begin(), lifetimes.end(),
+              [](const Lifetime &a, const Lifetime &b) {
+                  return a.start < b.start ||
+                         (a.start == b.start && a.opid < b.opid);
+              });
+
+    // (last cycle, reg) of busy registers, and ids of free registers
+    priority_queue<pair<int, int>, vector<pair<int, int>>,
+                   greater<pair<int, int>>>
+        busy;
+    priority_queue<int, vector<int>, greater<int>> idle;
+    std::fill(regs.begin(), regs.end(), -1);
+    n_reg = 0;
+
+    for (const auto &lt : lifetimes) {
+        while (!busy.empty() && busy.top().first < lt.start) {
+            idle.push(busy.top().second);
+            busy.pop();
+        }
+        int reg;
+        if (idle.empty()) {
+            reg = n_reg++;
+        } else {
+            reg = idle.top();
+            idle.pop();
+        }
+        regs[lt.opid] = reg;
+        busy.push(std::make_pair(lt.end, reg));
+    }
+    return 0;
+}
+
+// Display register binding result
+void RegisterBinder::print(bool verbose) const {
+    cerr << "Register Binding Result" << endl;
+    cerr << "Registers: " << n_reg << ", values: " << lifetimes.size()
+         << ", area: " << n_reg * hin->reg_area << endl;
+    if (!verbose) return;
+    cerr << "Value | Lifetime | Register" << endl;
+    for (const auto &lt : lifetimes)
+        cerr << lt.opid << ": [" << lt.start << ", " << lt.end << "], "
+             << regs[lt.opid] << endl;
+}
+
+};  // namespace hls
@@ -0,0 +1,71 @@
+#ifndef HLS_BIND_REG_H
+#define HLS_BIND_REG_H
+
+#include <vector>
+
+#include "io.h"
+
+using std::vector;
+
+namespace hls {
+
+// Live interval of a value held in a register, [start, end] in cycles
+class Lifetime {
+   public:
+    int opid;   // op producing the value
+    int start;  // first cycle the value is read from the register
+    int end;    // last cycle the value is read
+};
+
+// Register lifetime analysis and register binding
+// A value is written at the end of its op's last cycle, and must be held
+// until its last consumer reads it, possibly in a later block.
+// Phi nodes forward their inputs, so reading a phi reads all its inputs.
+// Values read by back edges are held from the start of the reading block
+// until their own block exits, covering the loop body in between.
+// Values read in a loop they are defined out of are held over all cycles of
+// the loop, as it may run again.
+class RegisterBinder {
+   protected:
+    const HLSInput *hin;
+    const HLSOutput *hout;
+    int n_operation;
+    vector<int> block_start;  // first cycle of each block, -1 if empty
+    vector<int> block_end;    // last cycle of each block, -1 if empty
+    vector<vector<bool>> loops;       // loop -> bbid -> in the loop body
+    vector<int> loop_start, loop_end;  // cycles each loop spans
+
+    void find_loops();
+
+    // Record a read of value opid at cycle in block bbid, resolving phi
+    // nodes
+    void add_use(int opid, int cycle, int bbid, vector<int> &first_hold,
+                 vector<int> &last_use, vector<bool> &visiting) const;
+
+   public:
+    vector<Lifetime> lifetimes;
+    vector<int> regs;  // opid -> register, -1 if no register needed
+    int n_reg = 0;
+
+    RegisterBinder(const HLSInput &hin, const HLSOutput &hout) {
+        this->hin = &hin;
+        this->hout = &hout;
+        this->n_operation = hin.n_operation;
+        regs.resize(n_operation, -1);
+    }
+
+    // Derive lifetimes from schedule
+    // Returns 0 on success, -1 on errors.
+    int analyze();
+
+    // Left edge binding of lifetimes to registers
+    // Returns 0 on success, -1 on errors.
+    int bind();
+
+    void copyout(HLSOutput &hout) { hout.n_reg = n_reg; }
+    void print(bool verbose = false) const;
+};
+
+};  // namespace hls
+
+#endif
@@ -0,0 +1,122 @@
+#include "sweep.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <thread>
+
+using std::greater;
+using std::priority_queue;
+
+namespace hls {
+
+int SweepBinder::bind_group(int rtid, vector<pair<int, int>> &ops) {
+    int occupancy = get_occupancy(hin->resource_types[rtid]);
+    std::sort(ops.begin(), ops.end());
+
+    // (free cycle, inst) of busy insts, and ids of free insts
+    priority_queue<pair<int, int>, vector<pair<int, int>>,
+                   greater<pair<int, int>>>
+        busy;
+    priority_queue<int, vector<int>, greater<int>> idle;
+    int n_inst = 0;
+
+    for (const auto &node : ops) {
+        int start = node.first;
+        int opid = node.second;
+
+        // release insts finished before start
+        while (!busy.empty() && busy.top().first <= start) {
+            idle.push(busy.top().second);
+            busy.pop();
+        }
+
+        // take the smallest free inst, or open a new one
+        int inst;
+        if (idle.empty()) {
+            inst = n_inst++;
+        } else {
+            inst = idle.top();
+            idle.pop();
+        }
+        binds[opid] = inst;
+        busy.push(std::make_pair(start + occupancy, inst));
+    }
+    return n_inst;
+}
+
+int SweepBinder::group_ops(vector<vector<pair<int, int>>> &groups) {
+    groups.assign(n_resource_type, vector<pair<int, int>>());
+    for (int opid = 0; opid < n_operation; opid++) {
+        binds[opid] = -1;
+        if (!hin->need_bind(hin->get_opcate(opid))) continue;
+        int rtid = hout->get_rtid(opid);
+        if (rtid == -1) {
+            cerr << "Error: op " << opid << " has no resource type" << endl;
+            return -1;
+        }
+        groups[rtid].push_back(std::make_pair(hout->scheds[opid], opid));
+    }
+    return 0;
+}
+
+int SweepBinder::bind() {
+    vector<vector<pair<int, int>>> groups;
+    if (group_ops(groups) < 0) return -1;
+
+    if (n_thread <= 1) {
+        for (int rtid = 0; rtid < n_resource_type; rtid++)
+            bind_group(rtid, groups[rtid]);
+        return 0;
+    }
+
+    // Balance workers: give larger groups first to the least loaded one.
+    // Each op is written by exactly one worker, so merging needs no lock.
+    vector<int> order(n_resource_type);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&groups](int a, int b) {
+        return groups[a].size() > groups[b].size();
+    });
+    vector<vector<int>> tasks(n_thread);
+    vector<size_t> loads(n_thread, 0);
+    for (auto rtid : order) {
+        if (groups[rtid].empty()) break;
+        int w = std::min_element(loads.begin(), loads.end()) - loads.begin();
+        tasks[w].push_back(rtid);
+        loads[w] += groups[rtid].size();
+    }
+
+    vector<std::thread> workers;
+    for (const auto &task : tasks) {
+        if (task.empty()) continue;
+        workers.emplace_back([this, &groups, &task]() {
+            for (auto rtid : task) bind_group(rtid, groups[rtid]);
+        });
+    }
+    for (auto &w : workers) w.join();
+    return 0;
+}
+
+int SweepBinder::bind_blocks(const vector<int> &bbids) {
+    binds = hout->binds;
+    for (auto bbid : bbids) {
+        vector<vector<pair<int, int>>> groups(n_resource_type);
+        for (auto opid : hin->blocks[bbid].ops) {
+            binds[opid] = -1;
+            if (!hin->need_bind(hin->get_opcate(opid))) continue;
+            int rtid = hout->get_rtid(opid);
+            if (rtid == -1) {
+                cerr << "Error: op " << opid << " has no resource type"
+                     << endl;
+                return -1;
+            }
+            groups[rtid].push_back(std::make_pair(hout->scheds[opid], opid));
+        }
+        for (int rtid = 0; rtid < n_resource_type; rtid++)
+            if (!groups[rtid].empty()) bind_group(rtid, groups[rtid]);
+    }
+    return 0;
+}
+
+};  // namespace hls
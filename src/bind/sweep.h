@@ -0,0 +1,53 @@
+#ifndef HLS_BIND_SWEEP_H
+#define HLS_BIND_SWEEP_H
+
+#include <vector>
+
+#include "base.h"
+#include "io.h"
+#include "reservation.h"
+
+using std::pair;
+using std::vector;
+
+namespace hls {
+
+// Binding operations to resource instances with left edge algorithm
+// Ops of one resource type form an interval graph over scheduled cycles,
+// so sweeping them by start cycle with a heap of free instances is optimal.
+// Runs in O(n log n) time and O(n) memory, without a conflict graph.
+// Resource types never conflict with each other, so their groups could be
+// binded on separate threads with the same result.
+class SweepBinder : public BaseBinder {
+   protected:
+    int n_resource_type;
+
+    // Group ops needing binding by resource type, as (start cycle, opid).
+    // Returns 0 on success, -1 on errors.
+    int group_ops(vector<vector<pair<int, int>>> &groups);
+
+    // Bind ops of one resource type, given as (start cycle, opid).
+    // Returns number of instances used.
+    int bind_group(int rtid, vector<pair<int, int>> &ops);
+
+   public:
+    int n_thread = 1;  // bind groups of resource types on worker threads
+
+    SweepBinder(const HLSInput &hin, const HLSOutput &hout)
+        : BaseBinder(hin, hout) {
+        n_resource_type = hin.n_resource_type;
+    }
+
+    // Returns 0 on success, -1 on errors.
+    int bind();
+
+    // Bind ops of the given blocks only, keeping hout's binds of others.
+    // Blocks never overlap in cycles, so this gives the same result as
+    // binding all ops again.
+    // Returns 0 on success, -1 on errors.
+    int bind_blocks(const vector<int> &bbids);
+};
+
+};  // namespace hls
+
+#endif
@@ -98,7 +98,8 @@ int topology_sort(AdjacentList g, const HLSInput &hin,
 // i.e., considering dependencies of ops allocated to the same resource type
 // Return 0 on success, -1 on errors (loops)
 int topology_sort(AdjacentList g, const HLSInput &hin,
-                  const vector<int> &ot2rtid, vector<vector<int>> &out) {
+                  const std::function<int(int)> &get_rtid,
+                  vector<vector<int>> &out) {
     out.resize(hin.n_resource_type, vector<int>());
     int cnt = 0;
 
@@ -116,8 +117,7 @@ int topology_sort(AdjacentList g, const HLSInput &hin,
         cnt++;
 
         // Record finished nodes, but write to different groups
-        auto otid = hin.operations[v].optype;
-        auto rtid = ot2rtid[otid];
+        auto rtid = get_rtid(v);
         if (hin.need_schedule(hin.get_opcate(v)) && rtid == -1)
             std::cerr << "Op " << v << " need scheduling but no resource type!"
                       << std::endl;
@@ -138,6 +138,17 @@ int topology_sort(AdjacentList g, const HLSInput &hin,
     return 0;
 }
 
+CDFGCache::CDFGCache(const HLSInput &hin) {
+    graphs.reserve(hin.n_block);
+    topos.resize(hin.n_block);
+    for (int bbid = 0; bbid < hin.n_block; bbid++) {
+        graphs.push_back(build_induced_graph(bbid, hin));
+        if (topology_sort(graphs[bbid], topos[bbid]) != 0)
+            std::cerr << "Error in topology sort of block " << bbid
+                      << std::endl;
+    }
+}
+
 // Sorting interval graph with left edge algorithm
 // In module binding, left edge is just its start cycle
 // Returns: vector of pairs, in which pair = (cycle, opid)
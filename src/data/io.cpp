@@ -1,10 +1,12 @@
 #include "io.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 
-void input_array(std::ifstream &fin, std::vector<int> &array, int len) {
+void input_array(std::istream &fin, std::vector<int> &array, int len) {
     for (int i = 0; i < len; i++) {
         int tmp;
         fin >> tmp;
@@ -22,7 +24,13 @@ void output_array(std::string name, const std::vector<int> &array, int len) {
 
 hls::HLSInput::HLSInput(char *filename) {
     std::ifstream fin(filename);
+    load(fin);
+    fin.close();
+}
 
+hls::HLSInput::HLSInput(std::istream &fin) { load(fin); }
+
+void hls::HLSInput::load(std::istream &fin) {
     // Resource library description
     fin >> n_resource_type >> n_op_type >> target_cp >> area_limit;
     for (int i = 0; i < n_resource_type; i++) {
@@ -59,11 +67,24 @@ hls::HLSInput::HLSInput(char *filename) {
             op.bbid = i;
         }
     }
-
-    fin.close();
+    // Optional attributes of operation types
+    op_attrs.resize(n_op_type, 0);
+    int n_attr;
+    if (fin >> n_attr) {
+        for (int i = 0; i < n_attr; i++) {
+            int optype, flags;
+            fin >> optype >> flags;
+            if (optype < 0 || optype >= n_op_type) {
+                std::cerr << "Input Error: Attribute of unknown optype "
+                          << optype << std::endl;
+                exit(-1);
+            }
+            op_attrs[optype] |= flags;
+        }
+    }
 }
 
-hls::ResourceType::ResourceType(std::ifstream &fin) {
+hls::ResourceType::ResourceType(std::istream &fin) {
     int seq, pipe;
     fin >> seq >> area;
     is_sequential = (seq != 0);
@@ -81,14 +102,14 @@ hls::ResourceType::ResourceType(std::ifstream &fin) {
     input_array(fin, comp_ops, n_comp_op);
 }
 
-hls::BasicBlock::BasicBlock(std::ifstream &fin) {
+hls::BasicBlock::BasicBlock(std::istream &fin) {
     fin >> n_op_in_block >> n_pred >> n_succ >> exp_times;
     input_array(fin, ops, n_op_in_block);
     input_array(fin, preds, n_pred);
     input_array(fin, succs, n_succ);
 }
 
-hls::Operation::Operation(std::ifstream &fin) {
+hls::Operation::Operation(std::istream &fin) {
     fin >> optype >> n_inputs;
     input_array(fin, inputs, n_inputs);
 }
@@ -107,16 +128,53 @@ void hls::HLSOutput::output() {
     // only arithmetic, boolean and compare operations need to bind resource
     // instances.
     for (int opid = 0; opid < n_operation; opid++) {
-        int optype = hin->operations[opid].optype;
         int rid = binds[opid];
         if (rid == -1) {
             std::cout << -1 << std::endl;
         } else {
-            std::cout << ot2rtid[optype] << ' ' << rid << std::endl;
+            std::cout << get_rtid(opid) << ' ' << rid << std::endl;
         }
     }
 }
 
+void hls::HLSInput::write(std::ostream &fout) const {
+    fout << n_resource_type << ' ' << n_op_type << ' ' << target_cp << ' '
+         << area_limit << std::endl;
+    for (const auto &rt : resource_types) {
+        fout << (int)rt.is_sequential << ' ' << rt.area << ' ';
+        if (rt.is_sequential)
+            fout << rt.latency << ' ' << rt.delay << ' ' << (int)rt.is_pipelined;
+        else
+            fout << rt.delay;
+        fout << ' ' << rt.n_comp_op;
+        for (auto ot : rt.comp_ops) fout << ' ' << ot;
+        fout << std::endl;
+    }
+
+    fout << n_block << ' ' << n_operation << std::endl;
+    for (int i = 0; i < n_op_type; i++)
+        fout << (int)op_types[i] << (i + 1 < n_op_type ? ' ' : '\n');
+    for (const auto &bb : blocks) {
+        fout << bb.n_op_in_block << ' ' << bb.n_pred << ' ' << bb.n_succ << ' '
+             << bb.exp_times;
+        for (auto opid : bb.ops) fout << ' ' << opid;
+        for (auto pred : bb.preds) fout << ' ' << pred;
+        for (auto succ : bb.succs) fout << ' ' << succ;
+        fout << std::endl;
+    }
+    for (const auto &op : operations) {
+        fout << op.optype << ' ' << op.n_inputs;
+        for (auto in : op.inputs) fout << ' ' << in;
+        fout << std::endl;
+    }
+
+    int n_attr = n_op_type - std::count(op_attrs.begin(), op_attrs.end(), 0);
+    if (n_attr == 0) return;
+    fout << n_attr << std::endl;
+    for (int i = 0; i < n_op_type; i++)
+        if (op_attrs[i]) fout << i << ' ' << op_attrs[i] << std::endl;
+}
+
 void hls::ResourceType::print() const {
     std::cout << "is_sequential: " << (int)is_sequential << std::endl;
     std::cout << "area: " << area << std::endl;
@@ -188,7 +246,10 @@ void hls::HLSInput::print() const {
                 s = "compare    (8)";
                 break;
         }
-        std::cout << s << std::endl;
+        std::cout << s;
+        if (op_attrs[i] & ATTR_COMMUTATIVE) std::cout << " commutative";
+        if (op_attrs[i] & ATTR_ASSOCIATIVE) std::cout << " associative";
+        std::cout << std::endl;
     }
     std::cout << std::endl;
 
@@ -14,5 +14,13 @@ bool HLSInput::need_bind(OpCategory opcate) const {
     return (opcate == OP_ARITHM || opcate == OP_BOOL || opcate == OP_COMPARE);
 }
 
+bool HLSInput::is_commutative(int optype) const {
+    return (op_attrs[optype] & ATTR_COMMUTATIVE) != 0;
+}
+
+bool HLSInput::is_associative(int optype) const {
+    return (op_attrs[optype] & ATTR_ASSOCIATIVE) != 0;
+}
+
 
 } // namespace hls
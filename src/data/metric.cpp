@@ -0,0 +1,52 @@
+#include <algorithm>
+
+#include "io.h"
+
+namespace hls {
+
+int HLSOutput::get_rtid(int opid) const {
+    int rtid = op2rtid[opid];
+    return rtid != -1 ? rtid : ot2rtid[hin->operations[opid].optype];
+}
+
+int HLSOutput::get_latency(int opid) const {
+    int rtid = get_rtid(opid);
+    if (rtid == -1) return 0;
+    return hin->resource_types[rtid].latency;
+}
+
+bool HLSOutput::get_block_range(int bbid, int &start, int &end) const {
+    bool found = false;
+    for (auto opid : hin->blocks[bbid].ops) {
+        if (scheds[opid] < 0) continue;
+        int op_end = scheds[opid] + get_latency(opid) + 1;
+        if (!found) {
+            start = scheds[opid];
+            end = op_end;
+            found = true;
+        } else {
+            start = std::min(start, scheds[opid]);
+            end = std::max(end, op_end);
+        }
+    }
+    return found;
+}
+
+float HLSOutput::get_weighted_latency() const {
+    float res = 0;
+    for (const auto &bb : hin->blocks) {
+        int start, end;
+        if (get_block_range(bb.bbid, start, end))
+            res += (end - start) * bb.exp_times;
+    }
+    return res;
+}
+
+int HLSOutput::get_area() const {
+    int res = n_reg * hin->reg_area;
+    for (int rtid = 0; rtid < n_resource_type; rtid++)
+        res += rinsts[rtid] * hin->resource_types[rtid].area;
+    return res;
+}
+
+}  // namespace hls
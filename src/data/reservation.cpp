@@ -0,0 +1,95 @@
+#include "reservation.h"
+
+namespace hls {
+
+int get_occupancy(const ResourceType &rt) {
+    return rt.is_pipelined ? 1 : rt.latency + 1;
+}
+
+ReservationTable::ReservationTable(const HLSInput &hin,
+                                   const vector<int> &capacity)
+    : capacity(capacity) {
+    for (const auto &rt : hin.resource_types)
+        occupancy.push_back(hls::get_occupancy(rt));
+    counts.resize(hin.n_resource_type);
+    slots.resize(hin.n_resource_type);
+}
+
+void ReservationTable::update(int rtid, int cycle, int delta) {
+    auto &count = counts[rtid];
+    int end = cycle + occupancy[rtid];
+    if (count.size() < end) count.resize(end, 0);
+    for (int c = cycle; c < end; c++) count[c] += delta;
+}
+
+int ReservationTable::get_busy(int rtid, int cycle) const {
+    const auto &count = counts[rtid];
+    return cycle < count.size() ? count[cycle] : 0;
+}
+
+bool ReservationTable::is_free(int rtid, int cycle) const {
+    int k = capacity[rtid];
+    if (k <= 0) return true;
+    for (int c = cycle; c < cycle + occupancy[rtid]; c++)
+        if (get_busy(rtid, c) >= k) return false;
+    return true;
+}
+
+int ReservationTable::first_fit(int rtid, int from) const {
+    int k = capacity[rtid];
+    if (k <= 0) return from;
+    // skip past the last full cycle in the window
+    int c = from;
+    while (true) {
+        int full = -1;
+        for (int t = c + occupancy[rtid] - 1; t >= c; t--) {
+            if (get_busy(rtid, t) >= k) {
+                full = t;
+                break;
+            }
+        }
+        if (full == -1) return c;
+        c = full + 1;
+    }
+}
+
+void ReservationTable::reserve(int rtid, int cycle) { update(rtid, cycle, 1); }
+
+void ReservationTable::release(int rtid, int cycle) {
+    update(rtid, cycle, -1);
+}
+
+bool ReservationTable::is_inst_free(int rtid, int inst, int cycle) const {
+    const auto &insts = slots[rtid];
+    if (inst >= insts.size()) return true;
+    const auto &busy = insts[inst];
+    for (int c = cycle; c < cycle + occupancy[rtid] && c < busy.size(); c++)
+        if (busy[c]) return false;
+    return true;
+}
+
+int ReservationTable::first_free_inst(int rtid, int cycle) const {
+    int n_inst = capacity[rtid] > 0 ? capacity[rtid] : slots[rtid].size() + 1;
+    for (int inst = 0; inst < n_inst; inst++)
+        if (is_inst_free(rtid, inst, cycle)) return inst;
+    return -1;
+}
+
+void ReservationTable::reserve_inst(int rtid, int inst, int cycle) {
+    auto &insts = slots[rtid];
+    if (insts.size() <= inst) insts.resize(inst + 1);
+    auto &busy = insts[inst];
+    int end = cycle + occupancy[rtid];
+    if (busy.size() < end) busy.resize(end, false);
+    for (int c = cycle; c < end; c++) busy[c] = true;
+    update(rtid, cycle, 1);
+}
+
+void ReservationTable::release_inst(int rtid, int inst, int cycle) {
+    auto &busy = slots[rtid][inst];
+    for (int c = cycle; c < cycle + occupancy[rtid] && c < busy.size(); c++)
+        busy[c] = false;
+    update(rtid, cycle, -1);
+}
+
+}  // namespace hls
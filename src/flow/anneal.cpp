@@ -0,0 +1,232 @@
+#include "anneal.h"
+
+#include <cmath>
+#include <limits>
+
+#include "allocate/perf.h"
+#include "pipeline.h"
+#include "portfolio.h"
+
+namespace hls {
+
+// Temperatures on relative changes of estimated latency
+static const double temp_start = 0.5;
+static const double temp_end = 0.005;
+// Relative margin over the best estimate, within which designs are
+// confirmed by real schedules
+static const float confirm_margin = 0.1;
+
+int AnnealSearch::get_area(const Design &design) const {
+    int area = 0;
+    for (int ot = 0; ot < hin->n_op_type; ot++)
+        if (design.ot2rtid[ot] != -1)
+            area += design.insts[ot] *
+                    hin->resource_types[design.ot2rtid[ot]].area;
+    return area;
+}
+
+float AnnealSearch::estimate(const Design &design) const {
+    PerfProfiler &profiler = session->get_profiler();
+    float res = 0;
+    for (int ot = 0; ot < hin->n_op_type; ot++) {
+        int rtid = design.ot2rtid[ot];
+        // unbound ops are not limited, as if each had an inst
+        if (rtid != -1)
+            res += profiler.estimate_perf(ot, hin->resource_types[rtid],
+                                          std::max(design.insts[ot], 1));
+    }
+    return res;
+}
+
+// Change the type of an optype, add or remove an inst, or move an inst
+// between optypes. Returns false if the move doesn't apply or exceeds the
+// area limit.
+bool AnnealSearch::mutate(Design &design, std::mt19937 &rng) const {
+    std::uniform_int_distribution<int> pick_ot(0, hin->n_op_type - 1);
+    int ot = pick_ot(rng);
+    if (design.ot2rtid[ot] == -1) return false;
+    int kind = std::uniform_int_distribution<int>(0, 3)(rng);
+    if (kind > 0 && !hin->need_bind(hin->op_types[ot])) return false;
+    switch (kind) {
+        case 0: {
+            const auto &comp = comp_types[ot];
+            if (comp.size() < 2) return false;
+            int k = std::uniform_int_distribution<int>(0, comp.size() - 1)(rng);
+            if (comp[k] == design.ot2rtid[ot]) return false;
+            design.ot2rtid[ot] = comp[k];
+            break;
+        }
+        case 1:
+            design.insts[ot]++;
+            break;
+        case 2:
+            if (design.insts[ot] <= 1) return false;
+            design.insts[ot]--;
+            break;
+        default: {
+            int to = pick_ot(rng);
+            if (to == ot || !hin->need_bind(hin->op_types[to]) ||
+                design.insts[ot] <= 1)
+                return false;
+            design.insts[ot]--;
+            design.insts[to]++;
+        }
+    }
+    return get_area(design) <= hin->area_limit;
+}
+
+bool AnnealSearch::is_expired() const {
+    return std::chrono::steady_clock::now() >= deadline;
+}
+
+// Schedule and bind a design, and keep it if it beats the best.
+// Gives up at the deadline, polled while scheduling and between phases.
+void AnnealSearch::confirm(const Design &design) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!tried.insert(design).second) return;
+        n_confirm++;
+    }
+
+    HLSOutput hout = session->new_output();
+    hout.ot2rtid = design.ot2rtid;
+    hout.insts = design.insts;
+    for (int ot = 0; ot < hin->n_op_type; ot++)
+        if (design.ot2rtid[ot] != -1)
+            hout.rinsts[design.ot2rtid[ot]] += design.insts[ot];
+
+    StopHook hook = [this](float partial) {
+        if (is_expired()) return true;
+        std::lock_guard<std::mutex> lock(mtx);
+        return partial >= best_wlat;
+    };
+    if (session->schedule(hout, true, hook) != 0 || is_expired() ||
+        session->bind(hout) < 0 || session->bind_registers(hout) < 0 ||
+        is_expired() || session->select_types(hout) < 0 || is_expired() ||
+        session->compact(hout) < 0)
+        return;
+    if (hout.get_area() > hin->area_limit || !is_valid_result(*hin, hout))
+        return;
+
+    float wlat = hout.get_weighted_latency();
+    std::lock_guard<std::mutex> lock(mtx);
+    if (wlat < best_wlat ||
+        (wlat == best_wlat && hout.get_area() < best.get_area())) {
+        best = hout;
+        best_wlat = wlat;
+        n_better++;
+    }
+}
+
+// One annealing chain, cooling down over the time left
+void AnnealSearch::walk(int seed, const Design &start) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    auto begin = std::chrono::steady_clock::now();
+    double span = std::max(
+        std::chrono::duration<double>(deadline - begin).count(), 1e-6);
+
+    Design cur = start;
+    float cur_cost = estimate(cur);
+    float best_cost = cur_cost;
+    confirm(cur);
+    int steps = 0;
+    while (!is_expired()) {
+        Design next = cur;
+        if (!mutate(next, rng)) continue;
+        float cost = estimate(next);
+        steps++;
+
+        double frac = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - begin)
+                          .count() /
+                      span;
+        double temp = temp_start * std::pow(temp_end / temp_start, frac);
+        double delta = (cost - cur_cost) / std::max(cur_cost, 1e-6f);
+        if (delta <= 0 || uniform(rng) < std::exp(-delta / temp)) {
+            cur = next;
+            cur_cost = cost;
+        }
+        // the estimator is coarse, so near-best designs are tried too
+        if (cost < best_cost * (1 + confirm_margin)) {
+            best_cost = std::min(best_cost, cost);
+            confirm(next);
+        }
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    n_step += steps;
+}
+
+int AnnealSearch::search() {
+    comp_types.assign(hin->n_op_type, vector<int>());
+    for (const auto &rt : hin->resource_types)
+        for (auto ot : rt.comp_ops) comp_types[ot].push_back(rt.rtid);
+
+    // the default pipeline is the one to beat, run to the end whatever the
+    // budget, so the search never does worse than the plain flow
+    best_wlat = std::numeric_limits<float>::infinity();
+    HLSOutput hout = session->new_output();
+    if (run_pipeline(ALLOC_ILP, *session, hout) == 0 &&
+        hout.get_area() <= hin->area_limit && is_valid_result(*hin, hout)) {
+        best = hout;
+        best_wlat = hout.get_weighted_latency();
+    }
+
+    // chains start from the performance allocator, or from types of
+    // minimum area if it leaves some optype out
+    PerfAllocator allocator(*hin, &session->get_profiler());
+    allocator.allocate_type(hin->area_limit);
+    allocator.copyout(hout = session->new_output());
+    bool allocated = true;
+    for (int ot = 0; ot < hin->n_op_type; ot++)
+        if (hin->need_schedule(hin->op_types[ot]) && hout.ot2rtid[ot] == -1)
+            allocated = false;
+    if (allocated) {
+        allocator.allocate_inst();
+        allocator.copyout(hout = session->new_output());
+    } else {
+        AreaAllocator fallback(*hin);
+        fallback.allocate_type();
+        fallback.allocate_inst();
+        fallback.copyout(hout = session->new_output());
+    }
+    Design start{hout.ot2rtid, hout.insts};
+    for (int ot = 0; ot < hin->n_op_type; ot++) {
+        if (!hin->need_schedule(hin->op_types[ot])) {
+            start.ot2rtid[ot] = -1;
+        } else if (start.ot2rtid[ot] == -1) {
+            cerr << "Anneal Search Error: Optype " << ot
+                 << " has no resource type" << endl;
+            return best_wlat < std::numeric_limits<float>::infinity() ? 0 : -1;
+        }
+        // insts limit bound ops only, others take no area
+        if (hin->need_bind(hin->op_types[ot]))
+            start.insts[ot] = std::max(start.insts[ot], 1);
+        else
+            start.insts[ot] = 0;
+    }
+    if (get_area(start) > hin->area_limit) {
+        cerr << "Anneal Search: no start under the area limit" << endl;
+        return best_wlat < std::numeric_limits<float>::infinity() ? 0 : -1;
+    }
+
+    // the budget is for the walks
+    deadline = std::chrono::steady_clock::now() +
+               std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                   std::chrono::duration<double>(budget));
+    vector<std::thread> workers;
+    for (int i = 0; i < n_thread; i++)
+        workers.emplace_back(&AnnealSearch::walk, this, i + 1, start);
+    for (auto &w : workers) w.join();
+
+    return best_wlat < std::numeric_limits<float>::infinity() ? 0 : -1;
+}
+
+void AnnealSearch::print() const {
+    cerr << "Anneal Search: " << n_step << " estimates, " << n_confirm
+         << " schedules, " << n_better << " improvements on " << n_thread
+         << " threads, weighted latency " << best_wlat << ", area "
+         << best.get_area() << endl;
+}
+
+}  // namespace hls
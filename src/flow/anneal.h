@@ -0,0 +1,79 @@
+#ifndef HLS_FLOW_ANNEAL_H
+#define HLS_FLOW_ANNEAL_H
+
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "io.h"
+#include "session.h"
+
+using std::vector;
+
+namespace hls {
+
+// An allocation in the search: type and num of insts of each optype
+struct Design {
+    vector<int> ot2rtid;  // length = n_op_type
+    vector<int> insts;    // length = n_op_type
+
+    bool operator<(const Design &x) const {
+        return ot2rtid != x.ot2rtid ? ot2rtid < x.ot2rtid : insts < x.insts;
+    }
+};
+
+// Parallel simulated annealing over ot2rtid and insts.
+// Each thread walks designs under the area limit, scored by the depth
+// profile estimator. Designs near the best estimate of their thread are
+// confirmed by a real schedule, each design once over all threads, and
+// the best confirmed one is kept, starting from the result of the
+// default pipeline.
+// The default pipeline always runs to the end, and the time budget counts
+// from the start of the walks, where all threads stop at it.
+class AnnealSearch {
+   private:
+    const Session *session;
+    const HLSInput *hin;
+    std::chrono::steady_clock::time_point deadline;
+    vector<vector<int>> comp_types;  // optype -> compatible rtids
+
+    std::mutex mtx;            // guards all below
+    std::set<Design> tried;    // designs confirmed or being confirmed
+    HLSOutput best;
+    float best_wlat;
+    int n_step = 0;
+    int n_confirm = 0;
+    int n_better = 0;
+
+    int get_area(const Design &design) const;
+    float estimate(const Design &design) const;
+    bool mutate(Design &design, std::mt19937 &rng) const;
+    bool is_expired() const;
+    void confirm(const Design &design);
+    void walk(int seed, const Design &start);
+
+   public:
+    int n_thread;
+    double budget;  // seconds
+
+    AnnealSearch(const Session &session, double budget)
+        : best(session.get_input()) {
+        this->session = &session;
+        this->hin = &session.get_input();
+        this->budget = budget;
+        n_thread = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Returns 0 on success, -1 if no valid design is found.
+    int search();
+
+    void copyout(HLSOutput &hout) const { hout = best; }
+    void print() const;
+};
+
+}  // namespace hls
+
+#endif
@@ -0,0 +1,297 @@
+#include "incremental.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "allocate/ilp.h"
+#include "bind/sweep.h"
+#include "portfolio.h"
+
+namespace hls {
+
+const char *get_flow_name(SynthFlow flow) {
+    switch (flow) {
+        case FLOW_PIPELINE:
+            return "pipeline";
+        case FLOW_PORTFOLIO:
+            return "portfolio";
+        case FLOW_MIN_AREA:
+            return "min-area";
+        case FLOW_ANNEAL:
+            return "anneal";
+        default:
+            return "unknown";
+    }
+}
+
+// FNV-1a over ints
+static void hash_int(uint64_t &h, long long v) {
+    for (int i = 0; i < 8; i++) {
+        h ^= (v >> (i * 8)) & 0xff;
+        h *= 1099511628211ULL;
+    }
+}
+
+static const uint64_t hash_seed = 14695981039346656037ULL;
+
+uint64_t hash_library(const HLSInput &hin) {
+    uint64_t h = hash_seed;
+    hash_int(h, hin.n_resource_type);
+    hash_int(h, hin.n_op_type);
+    hash_int(h, (long long)(hin.target_cp * 1000));
+    hash_int(h, hin.area_limit);
+    hash_int(h, hin.reg_area);
+    for (const auto &rt : hin.resource_types) {
+        hash_int(h, rt.is_sequential);
+        hash_int(h, rt.area);
+        hash_int(h, (long long)(rt.delay * 1000));
+        hash_int(h, rt.latency);
+        hash_int(h, rt.is_pipelined);
+        for (auto ot : rt.comp_ops) hash_int(h, ot);
+        hash_int(h, -1);
+    }
+    for (int ot = 0; ot < hin.n_op_type; ot++) {
+        hash_int(h, hin.op_types[ot]);
+        hash_int(h, hin.op_attrs[ot]);
+    }
+    return h;
+}
+
+uint64_t hash_block(const HLSInput &hin, int bbid) {
+    const auto &bb = hin.blocks[bbid];
+    map<int, int> op2idx;
+    for (int i = 0; i < bb.n_op_in_block; i++) op2idx[bb.ops[i]] = i;
+
+    uint64_t h = hash_seed;
+    hash_int(h, bb.n_op_in_block);
+    for (auto opid : bb.ops) {
+        const auto &op = hin.operations[opid];
+        hash_int(h, op.optype);
+        hash_int(h, op.n_inputs);
+        for (auto in : op.inputs) {
+            auto it = op2idx.find(in);
+            hash_int(h, it == op2idx.end() ? -1 : it->second);
+        }
+    }
+    return h;
+}
+
+SynthState::SynthState(const HLSInput &hin, const HLSOutput &hout,
+                       SynthFlow flow)
+    : flow(flow), ot2rtid(hout.ot2rtid), insts(hout.insts),
+      rinsts(hout.rinsts) {
+    lib_hash = hash_library(hin);
+    for (const auto &bb : hin.blocks) {
+        int start = 0, end = 0;
+        hout.get_block_range(bb.bbid, start, end);
+        vector<int> scheds, binds, rtids;
+        for (auto opid : bb.ops) {
+            int cycle = hout.scheds[opid];
+            scheds.push_back(cycle < 0 ? -1 : cycle - start);
+            binds.push_back(hout.binds[opid]);
+            rtids.push_back(hout.op2rtid[opid]);
+        }
+        bb_hashes.push_back(hash_block(hin, bb.bbid));
+        bb_lens.push_back(end - start);
+        bb_weights.push_back(bb.exp_times);
+        bb_scheds.push_back(scheds);
+        bb_binds.push_back(binds);
+        bb_rtids.push_back(rtids);
+    }
+}
+
+static void save_array(std::ostream &fout, const vector<int> &array) {
+    fout << array.size();
+    for (auto v : array) fout << ' ' << v;
+    fout << endl;
+}
+
+static void load_array(std::istream &fin, vector<int> &array) {
+    size_t len;
+    fin >> len;
+    array.resize(len);
+    for (auto &v : array) fin >> v;
+}
+
+int SynthState::save(const char *filename) const {
+    std::ofstream fout(filename);
+    if (!fout) {
+        cerr << "Error: Cannot write state to " << filename << endl;
+        return -1;
+    }
+    fout << lib_hash << ' ' << flow << endl;
+    save_array(fout, ot2rtid);
+    save_array(fout, insts);
+    save_array(fout, rinsts);
+    fout << bb_hashes.size() << endl;
+    for (size_t i = 0; i < bb_hashes.size(); i++) {
+        fout << bb_hashes[i] << ' ' << bb_lens[i] << ' ' << bb_weights[i]
+             << endl;
+        save_array(fout, bb_scheds[i]);
+        save_array(fout, bb_binds[i]);
+        save_array(fout, bb_rtids[i]);
+    }
+    return 0;
+}
+
+int SynthState::load(const char *filename) {
+    std::ifstream fin(filename);
+    if (!fin) {
+        cerr << "Error: Cannot read state from " << filename << endl;
+        return -1;
+    }
+    size_t n_block;
+    int flow_id;
+    fin >> lib_hash >> flow_id;
+    if (flow_id < 0 || flow_id >= N_SYNTH_FLOW) {
+        cerr << "Error: Unknown flow in " << filename << endl;
+        return -1;
+    }
+    flow = (SynthFlow)flow_id;
+    load_array(fin, ot2rtid);
+    load_array(fin, insts);
+    load_array(fin, rinsts);
+    fin >> n_block;
+    bb_hashes.resize(n_block);
+    bb_lens.resize(n_block);
+    bb_weights.resize(n_block);
+    bb_scheds.resize(n_block);
+    bb_binds.resize(n_block);
+    bb_rtids.resize(n_block);
+    for (size_t i = 0; i < n_block; i++) {
+        fin >> bb_hashes[i] >> bb_lens[i] >> bb_weights[i];
+        load_array(fin, bb_scheds[i]);
+        load_array(fin, bb_binds[i]);
+        load_array(fin, bb_rtids[i]);
+    }
+    if (!fin) {
+        cerr << "Error: Corrupted state in " << filename << endl;
+        return -1;
+    }
+    return 0;
+}
+
+// Types and insts the default pipeline starts from
+static void allocate_default(const Session &session, HLSOutput &hout) {
+    ILPAllocator allocator(session.get_input());
+    if (allocator.allocate_joint(&session.get_profiler()) != 0 &&
+        (allocator.allocate_resource_type() < 0 ||
+         allocator.allocate_operation_type() < 0))
+        return;
+    allocator.copyout(hout);
+}
+
+static bool is_reweighted(const HLSInput &hin, const SynthState &prev) {
+    if ((int)prev.bb_weights.size() != hin.n_block) return false;
+    for (const auto &bb : hin.blocks)
+        if (prev.bb_weights[bb.bbid] != bb.exp_times) return true;
+    return false;
+}
+
+// Whether allocation of the default pipeline under the previous weights
+// differs from the one under the current weights
+static bool is_realloc_needed(const Session &session,
+                              const SynthState &prev) {
+    HLSInput old_hin = session.get_input();
+    for (auto &bb : old_hin.blocks) bb.exp_times = prev.bb_weights[bb.bbid];
+    Session old_session(old_hin);
+    HLSOutput now = session.new_output(), old = old_session.new_output();
+    allocate_default(session, now);
+    allocate_default(old_session, old);
+    return now.ot2rtid != old.ot2rtid || now.insts != old.insts ||
+           now.rinsts != old.rinsts;
+}
+
+int run_incremental(const Session &session, const SynthState &prev,
+                    SynthFlow flow, HLSOutput &hout) {
+    const HLSInput &hin = session.get_input();
+    if (prev.lib_hash != hash_library(hin)) {
+        cerr << "Incremental: resource library changed" << endl;
+        return 1;
+    }
+    if (prev.flow != flow) {
+        cerr << "Incremental: state saved by flow "
+             << get_flow_name(prev.flow) << ", not " << get_flow_name(flow)
+             << endl;
+        return 1;
+    }
+    bool reweighted = is_reweighted(hin, prev);
+    if (reweighted && flow != FLOW_PIPELINE) {
+        cerr << "Incremental: new weights, flow " << get_flow_name(flow)
+             << " runs in full" << endl;
+        return 1;
+    }
+    if (reweighted && is_realloc_needed(session, prev)) {
+        cerr << "Incremental: new weights change allocation" << endl;
+        return 1;
+    }
+    hout.ot2rtid = prev.ot2rtid;
+    hout.insts = prev.insts;
+    hout.rinsts = prev.rinsts;
+
+    // saved blocks by content hash, so blocks are found wherever they moved
+    map<uint64_t, vector<int>> saved;
+    for (int bbid = 0; bbid < (int)prev.bb_hashes.size(); bbid++)
+        saved[prev.bb_hashes[bbid]].push_back(bbid);
+
+    // take unchanged blocks, preferring the saved block of the same id among
+    // equal ones, ops matched by position
+    auto scheduler = session.new_scheduler(hout, true);
+    vector<bool> taken(prev.bb_hashes.size(), false);
+    vector<int> changed;
+    for (const auto &bb : hin.blocks) {
+        int bbid = bb.bbid;
+        int from = -1;
+        auto it = saved.find(hash_block(hin, bbid));
+        if (it != saved.end()) {
+            for (auto cand : it->second) {
+                if (taken[cand]) continue;
+                if (from == -1 || cand == bbid) from = cand;
+            }
+        }
+        if (from == -1) {
+            changed.push_back(bbid);
+            continue;
+        }
+        // per-op types are selected again under new weights
+        const auto &rtids = prev.bb_rtids[from];
+        if (reweighted && std::any_of(rtids.begin(), rtids.end(),
+                                      [](int rtid) { return rtid != -1; })) {
+            changed.push_back(bbid);
+            continue;
+        }
+        taken[from] = true;
+        map<int, int> bb_sched;
+        for (int i = 0; i < bb.n_op_in_block; i++) {
+            bb_sched[bb.ops[i]] = prev.bb_scheds[from][i];
+            hout.binds[bb.ops[i]] = prev.bb_binds[from][i];
+            hout.op2rtid[bb.ops[i]] = prev.bb_rtids[from][i];
+        }
+        scheduler->set_block(bbid, bb_sched, prev.bb_lens[from]);
+    }
+    cerr << "Incremental: reused " << hin.n_block - changed.size() << " of "
+         << hin.n_block << " blocks" << endl;
+    if (changed.size() == hin.n_block) return 1;
+
+    // schedule changed blocks under previous insts, and patch offsets
+    if (scheduler->reschedule(changed) < 0) return -1;
+    scheduler->copyout(hout);
+
+    SweepBinder binder(hin, hout);
+    if (binder.bind_blocks(changed) < 0) return -1;
+    binder.copyout(hout);
+    if (session.bind_registers(hout) < 0) return -1;
+
+    // changed blocks may need resources never used before
+    if (!is_valid_result(hin, hout)) {
+        cerr << "Incremental: invalid result under previous allocation"
+             << endl;
+        return 1;
+    }
+
+    // per-op types trade latency of blocks by their weights
+    if (reweighted && session.select_types(hout) < 0) return -1;
+    return 0;
+}
+
+}  // namespace hls
@@ -0,0 +1,71 @@
+#ifndef HLS_FLOW_INCREMENTAL_H
+#define HLS_FLOW_INCREMENTAL_H
+
+#include <cstdint>
+#include <vector>
+
+#include "io.h"
+#include "session.h"
+
+using std::vector;
+
+namespace hls {
+
+// Flows a saved result could come from
+enum SynthFlow {
+    FLOW_PIPELINE = 0,  // default pipeline on the ILP allocation
+    FLOW_PORTFOLIO,     // best of all allocation strategies
+    FLOW_MIN_AREA,      // area minimization under latency targets
+    FLOW_ANNEAL,        // simulated annealing over types and insts
+    N_SYNTH_FLOW
+};
+
+const char *get_flow_name(SynthFlow flow);
+
+// Result of a previous run, saved for incremental re-synthesis.
+// Blocks are keyed by content hash, so they are found again wherever they
+// move in the input, and their ops are kept by position, as cycles in the
+// block, binds and per-op resource types. The flow and weights of blocks are
+// kept to tell if allocation should be decided again.
+class SynthState {
+   public:
+    uint64_t lib_hash = 0;  // resource library, op types and area
+    SynthFlow flow = FLOW_PIPELINE;
+    vector<int> ot2rtid;
+    vector<int> insts;
+    vector<int> rinsts;
+    vector<uint64_t> bb_hashes;
+    vector<int> bb_lens;
+    vector<float> bb_weights;  // exp_times
+    vector<vector<int>> bb_scheds;  // -1 if not scheduled
+    vector<vector<int>> bb_binds;
+    vector<vector<int>> bb_rtids;  // per-op resource types, -1 if none
+
+    SynthState() {}
+    SynthState(const HLSInput &hin, const HLSOutput &hout,
+               SynthFlow flow = FLOW_PIPELINE);
+
+    // Returns 0 on success, -1 on errors.
+    int save(const char *filename) const;
+    int load(const char *filename);
+};
+
+uint64_t hash_library(const HLSInput &hin);
+// Hash of ops in a block, with inputs from inside the block by position
+uint64_t hash_block(const HLSInput &hin, int bbid);
+
+// Keep allocation and unchanged blocks of a previous run of the same flow,
+// reschedule and rebind changed blocks only. If weights of blocks changed,
+// the default pipeline decides allocation under both weights, and it's kept
+// only if the decisions agree, as schedules in blocks don't depend on
+// weights. Other flows weigh their choices by the weights themselves, so
+// they run in full. Per-op types are then selected again from the optype
+// allocation, rescheduling blocks that had any.
+// Returns 0 on success, 1 if the previous run is of no use or gives an
+// invalid result, where a full run is needed, -1 on errors.
+int run_incremental(const Session &session, const SynthState &prev,
+                    SynthFlow flow, HLSOutput &hout);
+
+}  // namespace hls
+
+#endif
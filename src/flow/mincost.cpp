@@ -0,0 +1,241 @@
+#include "mincost.h"
+
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+namespace hls {
+
+int LatencyTarget::load(const char *filename) {
+    std::ifstream fin(filename);
+    if (!fin) {
+        cerr << "Error: Cannot open latency targets " << filename << endl;
+        return -1;
+    }
+    int bbid, cycles;
+    while (fin >> bbid >> cycles) {
+        if (bbid < 0 || bbid >= (int)blocks.size() || cycles <= 0) {
+            cerr << "Error: Bad latency target of block " << bbid << endl;
+            return -1;
+        }
+        blocks[bbid] = cycles;
+    }
+    if (!fin.eof()) {
+        cerr << "Error: Corrupted latency targets in " << filename << endl;
+        return -1;
+    }
+    return 0;
+}
+
+float LatencyTarget::get_miss(const HLSInput &hin,
+                              const HLSOutput &hout) const {
+    float miss = 0;
+    for (const auto &bb : hin.blocks) {
+        int start, end;
+        if (blocks[bb.bbid] < 0 || !hout.get_block_range(bb.bbid, start, end))
+            continue;
+        int len = end - start;
+        if (len > blocks[bb.bbid])
+            miss += (len - blocks[bb.bbid]) * bb.exp_times;
+    }
+    if (weighted >= 0)
+        miss += std::max(0.0f, hout.get_weighted_latency() - weighted);
+    return miss;
+}
+
+// Schedule and bind under the current design, compacting only if that
+// doesn't cost registers. Returns 0 on success, -1 on errors.
+int AreaMinimizer::evaluate(HLSOutput &hout) {
+    hout = session->new_output();
+    for (int ot = 0; ot < hin->n_op_type; ot++) {
+        hout.ot2rtid[ot] = ot2rtid[ot];
+        hout.insts[ot] = insts[ot];
+        if (ot2rtid[ot] != -1) hout.rinsts[ot2rtid[ot]] += insts[ot];
+    }
+    n_eval++;
+    if (session->schedule(hout, true) != 0 ||
+        session->bind(hout, std::thread::hardware_concurrency()) < 0 ||
+        session->bind_registers(hout) < 0)
+        return -1;
+    HLSOutput compacted = hout;
+    if (session->compact(compacted) < 0) return -1;
+    if (compacted.get_area() <= hout.get_area()) hout = compacted;
+    return 0;
+}
+
+// Keep hout if it meets the targets with less area, or misses them less
+// than the best so far
+void AreaMinimizer::accept(const HLSOutput &hout) {
+    float miss = target.get_miss(*hin, hout);
+    float best_miss = found ? target.get_miss(*hin, best) : 0;
+    if (!found || miss < best_miss ||
+        (miss == 0 && best_miss == 0 && hout.get_area() < best.get_area()))
+        best = hout;
+    found = true;
+}
+
+// Steps from the current design: one more inst of an optype, or as many
+// insts of a faster type
+vector<Step> AreaMinimizer::get_steps() const {
+    PerfProfiler &profiler = session->get_profiler();
+    vector<Step> steps;
+    for (int ot = 0; ot < hin->n_op_type; ot++) {
+        int rtid = ot2rtid[ot];
+        if (rtid == -1) continue;
+        const auto &rt = hin->resource_types[rtid];
+        float now = profiler.estimate_perf(ot, rt, insts[ot]);
+        auto add = [&](int to, int num) {
+            const auto &rto = hin->resource_types[to];
+            Step step;
+            step.optype = ot;
+            step.rtid = to;
+            step.num = num;
+            step.gain = now - profiler.estimate_perf(ot, rto, num);
+            step.cost = rto.area * num - rt.area * insts[ot];
+            steps.push_back(step);
+        };
+        add(rtid, insts[ot] + 1);
+        for (const auto &rto : hin->resource_types) {
+            if (rto.rtid == rtid || rto.latency >= rt.latency) continue;
+            const auto &comp = rto.comp_ops;
+            if (std::find(comp.begin(), comp.end(), ot) != comp.end())
+                add(rto.rtid, insts[ot]);
+        }
+    }
+    return steps;
+}
+
+void AreaMinimizer::apply(const Step &step) {
+    ot2rtid[step.optype] = step.rtid;
+    insts[step.optype] = step.num;
+}
+
+// Take the step with the most estimated gain per area until the targets
+// are met. If no step gains on the profiles, try each one with a real
+// schedule and take the best per area.
+// Returns 0 if met, 1 if no step is left, -1 on errors.
+int AreaMinimizer::grow(float &miss) {
+    HLSOutput hout = session->new_output();
+    while (miss > 0) {
+        vector<Step> steps = get_steps();
+        int pick = -1;
+        float best_score = 0;
+        for (int i = 0; i < steps.size(); i++) {
+            if (steps[i].gain <= 0) continue;
+            float score = steps[i].gain / std::max(steps[i].cost, 1);
+            if (score > best_score) {
+                best_score = score;
+                pick = i;
+            }
+        }
+        if (pick == -1) {
+            vector<int> saved_rtids = ot2rtid, saved_insts = insts;
+            for (int i = 0; i < steps.size(); i++) {
+                apply(steps[i]);
+                if (evaluate(hout) < 0) return -1;
+                float gain = miss - target.get_miss(*hin, hout);
+                float score = gain / std::max(steps[i].cost, 1);
+                if (gain > 0 && score > best_score) {
+                    best_score = score;
+                    pick = i;
+                }
+                ot2rtid = saved_rtids;
+                insts = saved_insts;
+            }
+        }
+        if (pick == -1) return 1;
+
+        apply(steps[pick]);
+        if (evaluate(hout) < 0) return -1;
+        accept(hout);
+        miss = target.get_miss(*hin, hout);
+    }
+    return 0;
+}
+
+// Cut insts, then move optypes to smaller types, while targets still hold
+void AreaMinimizer::trim() {
+    HLSOutput hout = session->new_output();
+    auto try_keep = [&]() {
+        if (evaluate(hout) < 0) return false;
+        if (target.get_miss(*hin, hout) > 0 ||
+            hout.get_area() >= best.get_area())
+            return false;
+        best = hout;
+        return true;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int ot = 0; ot < hin->n_op_type; ot++) {
+            if (insts[ot] <= 1) continue;
+            insts[ot]--;
+            if (try_keep())
+                changed = true;
+            else
+                insts[ot]++;
+        }
+    }
+    for (int ot = 0; ot < hin->n_op_type; ot++) {
+        int rtid = ot2rtid[ot];
+        if (rtid == -1) continue;
+        for (const auto &rto : hin->resource_types) {
+            const auto &comp = rto.comp_ops;
+            if (rto.area >= hin->resource_types[ot2rtid[ot]].area ||
+                std::find(comp.begin(), comp.end(), ot) == comp.end())
+                continue;
+            ot2rtid[ot] = rto.rtid;
+            if (!try_keep()) ot2rtid[ot] = rtid;
+            rtid = ot2rtid[ot];
+        }
+    }
+}
+
+int AreaMinimizer::minimize() {
+    // types of minimum area, one inst each
+    for (const auto &rt : hin->resource_types) {
+        for (auto ot : rt.comp_ops) {
+            int cur = ot2rtid[ot];
+            if (cur == -1 || rt.area < hin->resource_types[cur].area)
+                ot2rtid[ot] = rt.rtid;
+        }
+    }
+    for (int ot = 0; ot < hin->n_op_type; ot++) {
+        if (hin->need_schedule(hin->op_types[ot]) && ot2rtid[ot] == -1) {
+            cerr << "Error: Optype " << ot << " has no resource type" << endl;
+            return -1;
+        }
+        insts[ot] = (ot2rtid[ot] != -1);
+    }
+
+    HLSOutput hout = session->new_output();
+    if (evaluate(hout) < 0) return -1;
+    accept(hout);
+    float miss = target.get_miss(*hin, hout);
+    int ret = grow(miss);
+    if (ret != 0) return ret;
+    trim();
+    return 0;
+}
+
+void AreaMinimizer::copyout(HLSOutput &hout) const { hout = best; }
+
+void AreaMinimizer::print() const {
+    float miss = target.get_miss(*hin, best);
+    cerr << "Area Minimizer: area " << best.get_area() << ", weighted latency "
+         << best.get_weighted_latency();
+    if (target.weighted >= 0) cerr << " (target " << target.weighted << ")";
+    cerr << ", " << (miss == 0 ? "targets met" : "targets missed") << " after "
+         << n_eval << " schedules" << endl;
+    for (const auto &bb : hin->blocks) {
+        int start, end;
+        if (target.blocks[bb.bbid] < 0 ||
+            !best.get_block_range(bb.bbid, start, end))
+            continue;
+        cerr << "  block " << bb.bbid << ": " << end - start << " cycles"
+             << " (target " << target.blocks[bb.bbid] << ")" << endl;
+    }
+}
+
+}  // namespace hls
@@ -0,0 +1,83 @@
+#ifndef HLS_FLOW_MINCOST_H
+#define HLS_FLOW_MINCOST_H
+
+#include <vector>
+
+#include "io.h"
+#include "session.h"
+
+using std::vector;
+
+namespace hls {
+
+// Latency targets of the area minimization mode
+class LatencyTarget {
+   public:
+    float weighted = -1;  // sum of block length * exp_times, -1 if none
+    vector<int> blocks;   // cycles of each block, -1 if none
+
+    LatencyTarget(int n_block) { blocks.resize(n_block, -1); }
+
+    // Read lines of "bbid cycles". Returns 0 on success, -1 on errors.
+    int load(const char *filename);
+    // Excess over the targets, weighted by exp_times, 0 if all are met
+    float get_miss(const HLSInput &hin, const HLSOutput &hout) const;
+};
+
+// Change of one optype in the area minimization
+struct Step {
+    int optype;
+    int rtid;
+    int num;     // insts of rtid after the step
+    float gain;  // estimated latency saved on depth profiles
+    int cost;    // area added
+};
+
+// Dual of the pipeline: minimum area under latency targets.
+// Starts from types of minimum area with one inst each, then grows the
+// design one step at a time, adding an inst or moving an optype to a
+// faster type. Steps are ranked by gain on the depth profiles per area,
+// and each one is confirmed by a real schedule. When the profiles show no
+// gain, steps are ranked by real schedules instead. Once the targets are
+// met, insts and types are cut back while they still hold. Compaction is
+// kept only if it costs no area.
+// The area limit of the input is ignored.
+class AreaMinimizer {
+   private:
+    const Session *session;
+    const HLSInput *hin;
+    LatencyTarget target;
+    vector<int> ot2rtid;  // length = n_op_type
+    vector<int> insts;    // length = n_op_type
+
+    HLSOutput best;
+    bool found = false;
+    int n_eval = 0;
+
+    vector<Step> get_steps() const;
+    void apply(const Step &step);
+    int evaluate(HLSOutput &hout);
+    void accept(const HLSOutput &hout);
+    int grow(float &miss);
+    void trim();
+
+   public:
+    AreaMinimizer(const Session &session, const LatencyTarget &target)
+        : target(target), best(session.get_input()) {
+        this->session = &session;
+        this->hin = &session.get_input();
+        ot2rtid.resize(hin->n_op_type, -1);
+        insts.resize(hin->n_op_type, 0);
+    }
+
+    // Returns 0 if the targets are met, 1 if not (the fastest design
+    // tried is kept), -1 on errors.
+    int minimize();
+
+    void copyout(HLSOutput &hout) const;
+    void print() const;
+};
+
+}  // namespace hls
+
+#endif
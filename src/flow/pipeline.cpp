@@ -0,0 +1,208 @@
+#include "pipeline.h"
+
+#include <atomic>
+#include <thread>
+
+#include "allocate/area.h"
+#include "allocate/ilp.h"
+#include "allocate/perf.h"
+
+namespace hls {
+
+// Rounds of cutting inst bounds and rescheduling in the ILP pipeline
+static const int max_cut_round = 4;
+
+const char *get_strategy_name(AllocStrategy strategy) {
+    switch (strategy) {
+        case ALLOC_AREA:
+            return "area";
+        case ALLOC_PERF:
+            return "perf";
+        case ALLOC_ILP:
+            return "ilp";
+        default:
+            return "unknown";
+    }
+}
+
+// Check that every op needing scheduling has got a resource type
+static bool is_type_allocated(const HLSInput &hin, const HLSOutput &hout) {
+    for (int ot = 0; ot < hin.n_op_type; ot++)
+        if (hin.need_schedule(hin.op_types[ot]) && hout.ot2rtid[ot] == -1)
+            return false;
+    return true;
+}
+
+// Schedule under hout's insts, then bind ops and registers.
+// Returns 0 on success, 1 on cancellation, -1 on errors.
+static int schedule_and_bind(const Session &session, HLSOutput &hout,
+                             bool rlimit, const StopHook &should_stop) {
+    int ret = session.schedule(hout, rlimit, should_stop);
+    if (ret != 0) return ret;
+    if (session.bind(hout, std::thread::hardware_concurrency()) < 0)
+        return -1;
+    return session.bind_registers(hout);
+}
+
+static int run_area(const Session &session, HLSOutput &hout,
+                    const StopHook &should_stop) {
+    const HLSInput &hin = session.get_input();
+    AreaAllocator allocator(hin);
+    allocator.allocate_type();
+    allocator.allocate_inst();
+    allocator.copyout(hout);
+    if (!is_type_allocated(hin, hout)) return -1;
+    return schedule_and_bind(session, hout, true, should_stop);
+}
+
+static int run_perf(const Session &session, HLSOutput &hout,
+                    const StopHook &should_stop) {
+    const HLSInput &hin = session.get_input();
+    PerfAllocator allocator(hin, &session.get_profiler());
+    allocator.allocate_type(hin.area_limit);
+    allocator.copyout(hout);  // no insts yet, only types are written
+    if (!is_type_allocated(hin, hout)) return -1;
+
+    allocator.allocate_inst();
+    allocator.copyout(hout);
+    return schedule_and_bind(session, hout, true, should_stop);
+}
+
+// Predict the insts bound the unconstrained pass would end up with, from
+// the depth profiles instead of a schedule: ASAP runs at most the widest
+// level of each optype at once, and optypes on one type add up. Registers
+// are not predicted, so with register area the prediction misses more.
+// Returns as allocate_insts_bound.
+static int predict_bound(const Session &session, ILPAllocator &allocator,
+                         const HLSOutput &hout, vector<int> &bound) {
+    const HLSInput &hin = session.get_input();
+    const PerfProfiler &profiler = session.get_profiler();
+    bound.assign(hin.n_resource_type, 0);
+    for (int ot = 0; ot < hin.n_op_type; ot++) {
+        int rtid = hout.ot2rtid[ot];
+        if (rtid != -1 && hin.need_bind(hin.op_types[ot]))
+            bound[rtid] += profiler.get_max_width(ot);
+    }
+    return allocator.allocate_insts_bound(bound, 0);
+}
+
+static int run_ilp(const Session &session, HLSOutput &hout,
+                   const StopHook &should_stop) {
+    // allocate rtype, optype and num of instances together,
+    // fall back to allocating types only on failure
+    ILPAllocator allocator(session.get_input());
+    bool joint = (allocator.allocate_joint(&session.get_profiler()) == 0);
+    if (!joint) {
+        cerr << "Warning: Joint allocation fails, allocating types only"
+             << endl;
+        if (allocator.allocate_resource_type() < 0) {
+            cerr << "Error: Allocating Resource types!" << endl;
+            return -1;
+        }
+        if (allocator.allocate_operation_type() < 0) {
+            cerr << "Error: Allocating Operation types!" << endl;
+            return -1;
+        }
+    }
+    allocator.copyout(hout);
+
+    // Start the constrained pass under a predicted bound if asked,
+    // in parallel with the unconstrained one
+    HLSOutput spec = hout;
+    vector<int> bound;
+    std::atomic<bool> dropped(false);
+    int spec_ret = -1;
+    std::thread worker;
+    if (!joint && session.speculate &&
+        predict_bound(session, allocator, hout, bound) == 0) {
+        spec.rinsts = bound;
+        worker = std::thread([&]() {
+            StopHook hook = [&](float partial) {
+                return dropped || (should_stop && should_stop(partial));
+            };
+            spec_ret = schedule_and_bind(session, spec, true, hook);
+        });
+    }
+
+    // Scheduling and binding, under allocated insts if any
+    auto scheduler = session.new_scheduler(hout, joint, should_stop);
+    int ret = scheduler->schedule();
+    if (session.sched_log) scheduler->print();
+    if (ret == 0) {
+        scheduler->copyout(hout);
+        if (session.bind(hout, std::thread::hardware_concurrency()) < 0 ||
+            session.bind_registers(hout) < 0)
+            ret = -1;
+    }
+
+    // check area constraints
+    int res = -1;
+    if (ret == 0)
+        res = allocator.allocate_insts_bound(hout.rinsts, hout.n_reg);
+
+    // keep the speculative result if it's under the very bound, and its
+    // registers fit as well, otherwise cut on the unconstrained one
+    if (worker.joinable()) {
+        bool hit = (res == 0 && hout.rinsts == bound);
+        dropped = !hit;
+        worker.join();
+        if (hit && spec_ret == 0 &&
+            spec.get_area() <= session.get_input().area_limit) {
+            hout = spec;
+            return 0;
+        }
+    }
+
+    // reschedule under the new bounds if needed.
+    // Only blocks using more insts than the new bounds are solved again.
+    if (ret != 0) return ret;
+    if (res < 0) {
+        cerr << "Error: Allocate insts bound" << endl;
+        return -1;
+    }
+    // Rescheduling may lengthen lifetimes and take more registers, so cut
+    // bounds again until registers fit as well
+    for (int round = 0; res == 0 && round < max_cut_round; round++) {
+        if (session.reschedule(*scheduler, hout) < 0 ||
+            session.bind_registers(hout) < 0)
+            return -1;
+        res = allocator.allocate_insts_bound(hout.rinsts, hout.n_reg);
+        if (res < 0) {
+            cerr << "Error: Allocate insts bound" << endl;
+            return -1;
+        }
+    }
+    if (res == 0)
+        cerr << "Warning: Registers exceed the area limit after rescheduling"
+             << endl;
+    return 0;
+}
+
+int run_pipeline(AllocStrategy strategy, const Session &session,
+                 HLSOutput &hout, const StopHook &should_stop) {
+    int ret;
+    switch (strategy) {
+        case ALLOC_AREA:
+            ret = run_area(session, hout, should_stop);
+            break;
+        case ALLOC_PERF:
+            ret = run_perf(session, hout, should_stop);
+            break;
+        case ALLOC_ILP:
+            ret = run_ilp(session, hout, should_stop);
+            break;
+        default:
+            return -1;
+    }
+    if (ret != 0) return ret;
+    if (session.select_types(hout) < 0) return -1;
+    return session.compact(hout);
+}
+
+int run_pipeline(AllocStrategy strategy, const HLSInput &hin, HLSOutput &hout,
+                 const StopHook &should_stop) {
+    Session session(hin);
+    return run_pipeline(strategy, session, hout, should_stop);
+}
+
+}  // namespace hls
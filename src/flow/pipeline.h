@@ -0,0 +1,32 @@
+#ifndef HLS_FLOW_PIPELINE_H
+#define HLS_FLOW_PIPELINE_H
+
+#include "io.h"
+#include "schedule/base.h"
+#include "session.h"
+
+namespace hls {
+
+// Allocators a full pipeline could start from
+enum AllocStrategy {
+    ALLOC_AREA = 0,  // minimum area, one inst for each optype
+    ALLOC_PERF,      // DP on estimated latency, then add insts greedily
+    ALLOC_ILP,       // joint ILP, cut down insts if area exceeds
+    N_ALLOC_STRATEGY
+};
+
+const char *get_strategy_name(AllocStrategy strategy);
+
+// Run allocation, scheduling and binding of a strategy and write to hout.
+// should_stop is polled while scheduling for early cancellation.
+// Returns 0 on success, 1 on cancellation, -1 on errors.
+int run_pipeline(AllocStrategy strategy, const Session &session,
+                 HLSOutput &hout, const StopHook &should_stop = StopHook());
+
+// Run a pipeline in a session of its own
+int run_pipeline(AllocStrategy strategy, const HLSInput &hin, HLSOutput &hout,
+                 const StopHook &should_stop = StopHook());
+
+}  // namespace hls
+
+#endif
@@ -0,0 +1,91 @@
+#include "portfolio.h"
+
+#include <limits>
+#include <thread>
+
+#include "analysis/validate.h"
+
+namespace hls {
+
+Portfolio::Portfolio(const HLSInput &hin) : session(hin) {
+    this->hin = &hin;
+    results.assign(N_ALLOC_STRATEGY, HLSOutput(hin));
+    status.assign(N_ALLOC_STRATEGY, -1);
+    wlats.assign(N_ALLOC_STRATEGY, std::numeric_limits<float>::infinity());
+    best_wlat = std::numeric_limits<float>::infinity();
+}
+
+bool is_valid_result(const HLSInput &hin, const HLSOutput &hout) {
+    Validator validator(hin, hout);
+    return validator.check() == 0;
+}
+
+// A run has clearly lost if its lower bound can't beat the best
+bool Portfolio::should_stop(float partial) {
+    std::lock_guard<std::mutex> lock(mtx);
+    return partial >= best_wlat;
+}
+
+void Portfolio::update_best(AllocStrategy strategy) {
+    std::lock_guard<std::mutex> lock(mtx);
+    float wlat = wlats[strategy];
+    if (wlat < best_wlat || (wlat == best_wlat && best != -1 &&
+                             results[strategy].get_area() <
+                                 results[best].get_area())) {
+        best_wlat = wlat;
+        best = strategy;
+    }
+}
+
+void Portfolio::run_strategy(AllocStrategy strategy) {
+    auto &hout = results[strategy];
+    StopHook hook = [this](float partial) { return should_stop(partial); };
+
+    status[strategy] = run_pipeline(strategy, session, hout, hook);
+    if (status[strategy] != 0) return;
+    if (!is_valid_result(*hin, hout)) return;
+
+    wlats[strategy] = hout.get_weighted_latency();
+    update_best(strategy);
+}
+
+int Portfolio::run() {
+    vector<std::thread> workers;
+    for (int i = 0; i < N_ALLOC_STRATEGY; i++)
+        workers.emplace_back(&Portfolio::run_strategy, this, (AllocStrategy)i);
+    for (auto &w : workers) w.join();
+
+    if (best == -1) return -1;
+    return 0;
+}
+
+void Portfolio::copyout(HLSOutput &hout) {
+    if (best == -1) return;
+    const auto &res = results[best];
+    hout.ot2rtid = res.ot2rtid;
+    hout.op2rtid = res.op2rtid;
+    hout.insts = res.insts;
+    hout.rinsts = res.rinsts;
+    hout.scheds = res.scheds;
+    hout.binds = res.binds;
+}
+
+// Display result of each strategy
+void Portfolio::print() const {
+    cerr << "Portfolio Result" << endl;
+    cerr << "Strategy | Status | Area | Weighted latency" << endl;
+    for (int i = 0; i < N_ALLOC_STRATEGY; i++) {
+        const char *st = "error";
+        if (status[i] == 1)
+            st = "cancelled";
+        else if (status[i] == 0)
+            st = (wlats[i] < std::numeric_limits<float>::infinity())
+                     ? "valid"
+                     : "invalid";
+        cerr << get_strategy_name((AllocStrategy)i) << ": " << st << ", "
+             << results[i].get_area() << ", " << wlats[i]
+             << (i == best ? " (best)" : "") << endl;
+    }
+}
+
+}  // namespace hls
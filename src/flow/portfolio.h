@@ -0,0 +1,49 @@
+#ifndef HLS_FLOW_PORTFOLIO_H
+#define HLS_FLOW_PORTFOLIO_H
+
+#include <mutex>
+#include <vector>
+
+#include "io.h"
+#include "pipeline.h"
+#include "session.h"
+
+using std::vector;
+
+namespace hls {
+
+// Race full pipelines of all allocation strategies on separate threads.
+// Keep the valid result with minimum weighted latency, and cancel runs
+// whose partial latency already exceeds the best one.
+class Portfolio {
+   private:
+    const HLSInput *hin;
+    Session session;            // shared by all strategies
+    vector<HLSOutput> results;  // one for each strategy
+    vector<int> status;         // return value of each pipeline
+    vector<float> wlats;        // weighted latency, inf if invalid
+
+    std::mutex mtx;  // guards best_wlat
+    float best_wlat;
+    int best = -1;
+
+    void run_strategy(AllocStrategy strategy);
+    void update_best(AllocStrategy strategy);
+    bool should_stop(float partial);
+
+   public:
+    Portfolio(const HLSInput &hin);
+
+    // Returns 0 on success, -1 if no strategy gives a valid result.
+    int run();
+
+    void copyout(HLSOutput &hout);
+    void print() const;
+};
+
+// Check that the schedule and binding is legal, see Validator.
+bool is_valid_result(const HLSInput &hin, const HLSOutput &hout);
+
+}  // namespace hls
+
+#endif
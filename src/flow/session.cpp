@@ -0,0 +1,94 @@
+#include "session.h"
+
+#include "allocate/select.h"
+#include "bind/reg.h"
+#include "bind/sweep.h"
+#include "schedule/compact.h"
+
+namespace hls {
+
+PerfProfiler &Session::get_profiler() const {
+    std::call_once(profiler_flag,
+                   [this]() { profiler.reset(new PerfProfiler(*hin)); });
+    return *profiler;
+}
+
+std::unique_ptr<AdaptiveScheduler> Session::new_scheduler(
+    const HLSOutput &hout, bool rlimit, const StopHook &should_stop) const {
+    std::unique_ptr<AdaptiveScheduler> scheduler(
+        new AdaptiveScheduler(*hin, hout, rlimit));
+    scheduler->cache = &cache;
+    scheduler->should_stop = should_stop;
+    scheduler->log = sched_log;
+    return scheduler;
+}
+
+int Session::schedule(HLSOutput &hout, bool rlimit,
+                      const StopHook &should_stop) const {
+    auto scheduler = new_scheduler(hout, rlimit, should_stop);
+    int ret = scheduler->schedule();
+    if (sched_log) scheduler->print();
+    if (ret != 0) return ret;
+    scheduler->copyout(hout);
+    return 0;
+}
+
+int Session::reschedule(SDCScheduler &scheduler, HLSOutput &hout) const {
+    scheduler.rlimit = true;
+    vector<int> dirty = scheduler.get_dirty_blocks();
+    if (scheduler.reschedule(dirty) < 0) return -1;
+    scheduler.copyout(hout);
+
+    SweepBinder binder(*hin, hout);
+    if (binder.bind_blocks(dirty) < 0) return -1;
+    binder.copyout(hout);
+    return 0;
+}
+
+int Session::bind(HLSOutput &hout, int n_thread) const {
+    SweepBinder binder(*hin, hout);
+    binder.n_thread = n_thread;
+    if (binder.bind() < 0) return -1;
+    binder.copyout(hout);
+    return 0;
+}
+
+int Session::bind_registers(HLSOutput &hout) const {
+    RegisterBinder binder(*hin, hout);
+    if (binder.analyze() < 0 || binder.bind() < 0) return -1;
+    binder.copyout(hout);
+    return 0;
+}
+
+int Session::select_types(HLSOutput &hout) const {
+    TypeSelector selector(*hin, hout);
+    if (selector.select() == 0) return 0;
+
+    HLSOutput res = hout;
+    selector.copyout(res);
+    int ret = schedule(res, true);
+    if (ret != 0) return ret;
+    if (bind(res) < 0 || bind_registers(res) < 0) return -1;
+    if (res.get_area() > hin->area_limit ||
+        res.get_weighted_latency() >= hout.get_weighted_latency())
+        return 0;
+    hout = res;
+    return 0;
+}
+
+int Session::compact(HLSOutput &hout) const {
+    Compactor compactor(*hin, hout);
+    if (compactor.compact() == 0) return 0;
+
+    // moving ops earlier may lengthen lifetimes of values
+    HLSOutput res = hout;
+    compactor.copyout(res);
+    if (bind_registers(res) < 0) return -1;
+    if (res.get_area() > hin->area_limit &&
+        res.get_area() > hout.get_area())
+        return 0;
+    hout = res;
+    return 0;
+}
+
+}  // namespace hls
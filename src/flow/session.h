@@ -0,0 +1,76 @@
+#ifndef HLS_FLOW_SESSION_H
+#define HLS_FLOW_SESSION_H
+
+#include <istream>
+#include <memory>
+#include <mutex>
+
+#include "allocate/perf.h"
+#include "graph.h"
+#include "io.h"
+#include "schedule/base.h"
+#include "schedule/adaptive.h"
+
+namespace hls {
+
+// Reentrant session over one input
+// Owns an immutable input and data derived from it (induced graphs,
+// topology orders, depth profiles), built once and shared by all phases.
+// Phases are const calls on a caller-owned HLSOutput, which they view
+// instead of copying, so one session could serve many threads and
+// exploration rounds without re-parsing the input.
+class Session {
+   private:
+    std::shared_ptr<const HLSInput> hin;
+    CDFGCache cache;
+    mutable std::once_flag profiler_flag;
+    mutable std::unique_ptr<PerfProfiler> profiler;
+
+   public:
+    Session(std::shared_ptr<const HLSInput> hin)
+        : hin(hin), cache(*hin) {}
+    Session(std::istream &fin)
+        : Session(std::make_shared<const HLSInput>(fin)) {}
+    // View hin without owning it, hin must outlive the session
+    Session(const HLSInput &hin)
+        : Session(std::shared_ptr<const HLSInput>(&hin,
+                                                  [](const HLSInput *) {})) {}
+
+    const HLSInput &get_input() const { return *hin; }
+    const CDFGCache &get_cache() const { return cache; }
+    PerfProfiler &get_profiler() const;  // built on first call
+
+    HLSOutput new_output() const { return HLSOutput(*hin); }
+
+    std::ostream *sched_log = nullptr;  // optional, log engine choices
+    bool speculate = false;  // run the constrained pass speculatively
+
+    // Scheduler viewing hout and the session's cache, kept by callers
+    // for rescheduling some blocks later
+    std::unique_ptr<AdaptiveScheduler> new_scheduler(
+        const HLSOutput &hout, bool rlimit,
+        const StopHook &should_stop = StopHook()) const;
+
+    // Phases: each returns 0 on success, 1 on cancellation, -1 on errors.
+    // Schedule under hout's allocation
+    int schedule(HLSOutput &hout, bool rlimit,
+                 const StopHook &should_stop = StopHook()) const;
+    // Reschedule blocks exceeding hout's rinsts, and rebind their ops only
+    int reschedule(SDCScheduler &scheduler, HLSOutput &hout) const;
+    // Bind ops to insts, and set hout's insts to those used
+    int bind(HLSOutput &hout, int n_thread = 1) const;
+    // Bind values to registers
+    int bind_registers(HLSOutput &hout) const;
+    // Move ops to other compatible types by slack and exp_times, then
+    // schedule and bind again. Kept only if weighted latency improves
+    // under the area limit.
+    int select_types(HLSOutput &hout) const;
+    // Move ops earlier into free slots of insts and shrink blocks, then
+    // bind registers again. Kept only if the area stays within the limit
+    // or doesn't grow, as results of flows ignoring the limit may be over.
+    int compact(HLSOutput &hout) const;
+};
+
+}  // namespace hls
+
+#endif
@@ -1,63 +1,256 @@
+#include <fstream>
 #include <iostream>
+#include <string>
 
-#include "allocate/ilp.h"
-#include "bind/base.h"
+#include "allocate/prune.h"
+#include "analysis/util.h"
+#include "bind/mux.h"
+#include "bind/reg.h"
+#include "flow/anneal.h"
+#include "flow/incremental.h"
+#include "flow/mincost.h"
+#include "flow/pipeline.h"
+#include "flow/portfolio.h"
 #include "io.h"
-#include "schedule/sdc.h"
+#include "transform/balance.h"
+#include "transform/ifconv.h"
+#include "transform/redundancy.h"
+#include "transform/reweight.h"
 
+// Usage: hls <input> [--portfolio] [--mux] [--reg-area=N]
+//            [--save-state=FILE] [--incremental=FILE] [--log-sched]
+//            [--speculate] [--report=FILE] [--gantt] [--if-convert=FILE]
+//            [--cse] [--balance=FILE] [--min-area=W] [--block-targets=FILE]
+//            [--anneal=SECONDS] [--profile=FILE]
+//   --portfolio         race all allocation strategies and keep the best
+//   --mux               rebind to minimize mux inputs, and report mux fan-in
+//   --reg-area=N        count N area for each register, and report registers
+//   --save-state=FILE   save the result for later incremental runs
+//   --incremental=FILE  reuse allocation and unchanged blocks of a result
+//                       saved by the same flow, falling back to a full run
+//                       if it's no use
+//   --log-sched         log the scheduling engine chosen for each block
+//   --speculate         start the resource constrained pass from a predicted
+//                       bound, in parallel with the unconstrained one
+//   --report=FILE       write utilization and bottlenecks as JSON
+//   --gantt             print an ASCII Gantt chart of insts of each block
+//   --if-convert=FILE   merge small branch diamonds into predicated blocks,
+//                       and write the converted input, which the result is
+//                       valid on unless --balance is given too
+//   --cse               remove common subexpressions and dead ops
+//   --balance=FILE      regroup associative chains into trees, and write the
+//                       reshaped input, which the result is valid on
+//   --min-area=W        minimize area under weighted latency W instead,
+//                       ignoring the area limit
+//   --block-targets=FILE  same, under cycles of blocks in lines of
+//                       "bbid cycles", together with W if given
+//   --anneal=SECONDS    search types and insts by parallel simulated
+//                       annealing, with a time budget after the default
+//                       flow
+//   --profile=FILE      override exp_times with measured block counts and
+//                       branch probabilities, see Reweighter. With
+//                       --incremental, allocation is redone only if the
+//                       new weights change it
 int main(int argc, char* argv[]) {
-    if (argc != 2) exit(-1);
+    if (argc < 2) exit(-1);
+    bool portfolio = false;
+    bool mux = false;
+    int reg_area = -1;
+    bool log_sched = false;
+    bool speculate = false;
+    bool gantt = false;
+    std::string if_convert;
+    bool cse = false;
+    std::string balance;
+    float min_area = -1;
+    std::string block_targets;
+    double anneal = -1;
+    std::string profile;
+    std::string report;
+    std::string save_state, prev_state;
+    for (int i = 2; i < argc; i++) {
+        std::string opt(argv[i]);
+        if (opt == "--portfolio") {
+            portfolio = true;
+        } else if (opt == "--mux") {
+            mux = true;
+        } else if (opt.rfind("--reg-area=", 0) == 0) {
+            reg_area = std::stoi(opt.substr(11));
+        } else if (opt == "--speculate") {
+            speculate = true;
+        } else if (opt == "--gantt") {
+            gantt = true;
+        } else if (opt.rfind("--if-convert=", 0) == 0) {
+            if_convert = opt.substr(13);
+        } else if (opt == "--cse") {
+            cse = true;
+        } else if (opt.rfind("--balance=", 0) == 0) {
+            balance = opt.substr(10);
+        } else if (opt.rfind("--min-area=", 0) == 0) {
+            min_area = std::stof(opt.substr(11));
+        } else if (opt.rfind("--block-targets=", 0) == 0) {
+            block_targets = opt.substr(16);
+        } else if (opt.rfind("--anneal=", 0) == 0) {
+            anneal = std::stod(opt.substr(9));
+        } else if (opt.rfind("--profile=", 0) == 0) {
+            profile = opt.substr(10);
+        } else if (opt.rfind("--report=", 0) == 0) {
+            report = opt.substr(9);
+        } else if (opt == "--log-sched") {
+            log_sched = true;
+        } else if (opt.rfind("--save-state=", 0) == 0) {
+            save_state = opt.substr(13);
+        } else if (opt.rfind("--incremental=", 0) == 0) {
+            prev_state = opt.substr(14);
+        } else {
+            cerr << "Main Error: Unknown option " << opt << endl;
+            exit(-1);
+        }
+    }
+
     hls::HLSInput hls_input(argv[1]);
+    if (reg_area >= 0) hls_input.reg_area = reg_area;
+    if (!profile.empty()) {
+        hls::Reweighter reweighter(hls_input);
+        if (reweighter.load(profile.c_str()) < 0) exit(-1);
+        if (reweighter.reweight() > 0) reweighter.print();
+        hls_input = reweighter.get_reweighted();
+    }
+    if (!if_convert.empty()) {
+        hls::IfConverter converter(hls_input);
+        if (converter.convert() > 0) converter.print();
+        hls_input = converter.get_converted();
+        std::ofstream fout(if_convert);
+        hls_input.write(fout);
+    }
+    if (!balance.empty()) {
+        hls::TreeBalancer balancer(hls_input);
+        if (balancer.balance() > 0) balancer.print();
+        hls_input = balancer.get_balanced();
+        std::ofstream fout(balance);
+        hls_input.write(fout);
+    }
     // hls_input.print();
 
-    hls::HLSOutput hls_output(hls_input);
+    // run on the library without dominated types, map ids back at last
+    hls::TypePruner pruner(hls_input);
+    if (pruner.prune() > 0) pruner.print();
+    const hls::HLSInput& reduced_input = pruner.get_reduced();
 
-    // allocate rtype, without setting num of instances
-    hls::ILPAllocator allocator(hls_input);
-    if (allocator.allocate_resource_type() < 0) {
-        cerr << "Main Error: Allocating Resource types!" << endl;
-        exit(-1);
-    }
-    if (allocator.allocate_operation_type() < 0) {
-        cerr << "Main Error: Allocating Operation types!" << endl;
-        exit(-1);
-    }
-    allocator.copyout(hls_output);
+    // remove redundant ops, placing them back at last
+    hls::RedundancyEliminator eliminator(reduced_input);
+    if (cse && eliminator.eliminate() > 0) eliminator.print();
+    const hls::HLSInput& flow_input =
+        cse ? eliminator.get_reduced() : reduced_input;
+    hls::HLSOutput hls_output(flow_input);
+    hls::Session session(flow_input);
+    if (log_sched) session.sched_log = &cerr;
+    session.speculate = speculate;
 
-    // Scheduling and binding, regardless of area limit
-    hls::SDCScheduler scheduler(hls_input, hls_output, false);
-    hls::RBinder binder(hls_input, hls_output);
+    hls::SynthFlow flow = hls::FLOW_PIPELINE;
+    if (min_area >= 0 || !block_targets.empty())
+        flow = hls::FLOW_MIN_AREA;
+    else if (anneal >= 0)
+        flow = hls::FLOW_ANNEAL;
+    else if (portfolio)
+        flow = hls::FLOW_PORTFOLIO;
 
-    if (scheduler.schedule() < 0) {
-        cerr << "Main Error: Scheduling." << endl;
-        exit(-1);
-    }
-    scheduler.copyout(hls_output);
-    if (binder.bind() < 0) {
-        cerr << "Main Error: Binding." << endl;
-        exit(-1);
+    bool done = false;
+    if (!prev_state.empty()) {
+        hls::SynthState prev;
+        if (prev.load(prev_state.c_str()) < 0) exit(-1);
+        int ret = hls::run_incremental(session, prev, flow, hls_output);
+        if (ret < 0) {
+            cerr << "Main Error: Incremental run." << endl;
+            exit(-1);
+        }
+        done = (ret == 0);
+        if (!done) hls_output = hls::HLSOutput(flow_input);
     }
-    binder.copyout(hls_output);
 
-    // check area constraints
-    int res = allocator.allocate_insts_bound(hls_output.rinsts);
-    if (res < 0) {
-        cerr << "Main Error: Allocate insts bound" << endl;
-        exit(-1);
-    } else if (res == 0) {
-        scheduler.rlimit = true;
-        if (scheduler.schedule() < 0) {
-            cerr << "Main Error: Scheduling." << endl;
+    if (done) {
+        // nothing else to run
+    } else if (min_area >= 0 || !block_targets.empty()) {
+        hls::LatencyTarget target(flow_input.n_block);
+        target.weighted = min_area;
+        if (!block_targets.empty() &&
+            target.load(block_targets.c_str()) < 0)
+            exit(-1);
+        hls::AreaMinimizer minimizer(session, target);
+        int ret = minimizer.minimize();
+        if (ret < 0) {
+            cerr << "Main Error: Minimizing area." << endl;
             exit(-1);
         }
-        scheduler.copyout(hls_output);
+        minimizer.copyout(hls_output);
+        minimizer.print();
+        if (ret > 0) cerr << "Warning: Latency targets are not met" << endl;
+    } else if (anneal >= 0) {
+        hls::AnnealSearch searcher(session, anneal);
+        int ret = searcher.search();
+        searcher.print();
+        if (ret < 0) {
+            cerr << "Main Error: No valid design is found." << endl;
+            exit(-1);
+        }
+        searcher.copyout(hls_output);
+    } else if (portfolio) {
+        hls::Portfolio runner(flow_input);
+        int ret = runner.run();
+        runner.print();
+        if (ret < 0) {
+            cerr << "Main Error: No strategy gives a valid result." << endl;
+            exit(-1);
+        }
+        runner.copyout(hls_output);
+    } else if (hls::run_pipeline(hls::ALLOC_ILP, session, hls_output) != 0) {
+        cerr << "Main Error: Running pipeline." << endl;
+        exit(-1);
+    }
+
+    // binding never changes the schedule, so rebind on the final one
+    if (mux) {
+        hls::MuxBinder binder(flow_input, hls_output);
         if (binder.bind() < 0) {
             cerr << "Main Error: Binding." << endl;
             exit(-1);
         }
         binder.copyout(hls_output);
+        binder.print(true);
+    }
+
+    if (reg_area >= 0) {
+        hls::RegisterBinder reg_binder(flow_input, hls_output);
+        reg_binder.analyze();
+        reg_binder.bind();
+        reg_binder.print();
     }
 
-    hls_output.output();
+    if (!save_state.empty()) {
+        hls::SynthState state(flow_input, hls_output, flow);
+        if (state.save(save_state.c_str()) < 0) exit(-1);
+    }
+
+    hls::HLSOutput reduced_output(reduced_input);
+    if (eliminator.copyout(hls_output, reduced_output) < 0) {
+        cerr << "Main Error: Placing removed ops." << endl;
+        exit(-1);
+    }
+    hls::HLSOutput final_output(hls_input);
+    pruner.copyout(reduced_output, final_output);
+
+    if (!report.empty() || gantt) {
+        hls::UtilizationReport util(hls_input, final_output);
+        if (util.analyze() < 0) {
+            cerr << "Main Error: Utilization report." << endl;
+            exit(-1);
+        }
+        if (gantt) util.print_gantt(cerr);
+        if (!report.empty()) {
+            std::ofstream fout(report);
+            util.print_json(fout);
+        }
+    }
+    final_output.output();
     return 0;
-}
\ No newline at end of file
+}
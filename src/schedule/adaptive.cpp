@@ -0,0 +1,121 @@
+#include "adaptive.h"
+
+#include <chrono>
+
+namespace hls {
+
+const char *get_engine_name(SchedEngine engine) {
+    switch (engine) {
+        case ENGINE_ASAP:
+            return "asap";
+        case ENGINE_LIST:
+            return "list";
+        case ENGINE_SDC:
+            return "sdc";
+        default:
+            return "unknown";
+    }
+}
+
+// Compute features of all blocks from their ASAP schedules, except for
+// contention. Returns 0 on success, -1 on errors.
+int AdaptiveScheduler::analyze() {
+    features.assign(n_block, BlockFeature());
+    asap_scheds.assign(n_block, map<int, int>());
+    total_weight = 0;
+    for (int bbid = 0; bbid < n_block; bbid++) {
+        auto &feat = features[bbid];
+        auto &asap = asap_scheds[bbid];
+        feat.depth = schedule_asap(bbid, asap);
+        if (feat.depth < 0) return -1;
+
+        map<int, int> starts;  // cycle -> num of ops
+        for (const auto &it : asap) {
+            if (it.second == -1) continue;
+            feat.n_op++;
+            feat.width = std::max(feat.width, ++starts[it.second]);
+        }
+        feat.weight = hin->blocks[bbid].exp_times * feat.depth;
+        total_weight += feat.weight;
+    }
+    return 0;
+}
+
+// Contention depends on rinsts, which may change between runs
+bool AdaptiveScheduler::is_contended(int bbid) const {
+    if (!rlimit) return false;
+    for (const auto &it : get_usage(asap_scheds[bbid])) {
+        int k = rinsts[it.first];
+        if (k > 0 && it.second > k) return true;
+    }
+    return false;
+}
+
+SchedEngine AdaptiveScheduler::choose(int bbid) const {
+    const auto &feat = features[bbid];
+    if (!feat.contended) return ENGINE_ASAP;
+    bool hot = feat.weight > hot_ratio * total_weight;
+    if (feat.n_op > max_exact_ops && !hot) return ENGINE_LIST;
+    return ENGINE_SDC;
+}
+
+int AdaptiveScheduler::schedule_block(int bbid, map<int, int> &res) {
+    auto start = std::chrono::steady_clock::now();
+    if (total_weight < 0 && analyze() < 0) return -1;
+    features[bbid].contended = is_contended(bbid);
+
+    SchedEngine engine = choose(bbid);
+    int ret = -1;
+    if (engine == ENGINE_ASAP) {
+        res = asap_scheds[bbid];
+        ret = features[bbid].depth;
+    } else {
+        list.rlimit = rlimit;
+        list.cache = cache;
+        ret = list.schedule_block(bbid, res);
+    }
+
+    // resource constraints of SDC are ordering heuristics, so keep the list
+    // schedule if it's shorter
+    if (engine == ENGINE_SDC && ret >= 0) {
+        map<int, int> sdc_res;
+        int sdc_ret = SDCScheduler::schedule_block(bbid, sdc_res);
+        if (sdc_ret < 0) {
+            cerr << "Warning: SDC fails on block " << bbid
+                 << ", use list scheduling instead" << endl;
+        } else if (sdc_ret <= ret) {
+            res = sdc_res;
+            ret = sdc_ret;
+        }
+    }
+
+    engines[bbid] = engine;
+    times[bbid] = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    if (log) {
+        const auto &feat = features[bbid];
+        *log << "block " << bbid << ": " << get_engine_name(engine)
+             << ", ops " << feat.n_op << ", depth " << feat.depth
+             << ", width " << feat.width << ", weight " << feat.weight
+             << (feat.contended ? ", contended" : "") << ", " << times[bbid]
+             << " ms" << endl;
+    }
+    return ret;
+}
+
+void AdaptiveScheduler::print() const {
+    vector<int> counts(N_SCHED_ENGINE, 0);
+    vector<double> spent(N_SCHED_ENGINE, 0);
+    for (auto bbid : order) {
+        counts[engines[bbid]]++;
+        spent[engines[bbid]] += times[bbid];
+    }
+
+    cerr << "Adaptive Scheduler" << endl;
+    for (int e = 0; e < N_SCHED_ENGINE; e++)
+        cerr << "  " << get_engine_name((SchedEngine)e) << ": " << counts[e]
+             << " blocks, " << spent[e] << " ms" << endl;
+}
+
+}  // namespace hls
@@ -0,0 +1,59 @@
+#ifndef HLS_SCHEDULE_ADAPTIVE_H
+#define HLS_SCHEDULE_ADAPTIVE_H
+
+#include "io.h"
+#include "list.h"
+#include "sdc.h"
+
+namespace hls {
+
+enum SchedEngine { ENGINE_ASAP, ENGINE_LIST, ENGINE_SDC, N_SCHED_ENGINE };
+
+const char *get_engine_name(SchedEngine engine);
+
+// Cheap statistics of a block, from its ASAP schedule
+struct BlockFeature {
+    int n_op = 0;            // ops needing scheduling
+    int depth = 0;           // cycles of ASAP schedule
+    int width = 0;           // max ops starting in one cycle
+    bool contended = false;  // ASAP uses more insts than rinsts
+    float weight = 0;        // exp_times * depth
+};
+
+// Dispatch each block to the cheapest engine that matters:
+// - ASAP if it's free of contention, which is optimal then,
+// - list scheduling for large blocks of little weight,
+// - SDC for the others, which are hot and worth an LP, keeping the list
+//   schedule instead if it's shorter.
+class AdaptiveScheduler : public SDCScheduler {
+   private:
+    ListScheduler list;
+    vector<BlockFeature> features;
+    vector<map<int, int>> asap_scheds;
+    vector<SchedEngine> engines;   // engine of each block
+    vector<double> times;          // ms spent on each block
+    float total_weight = -1;       // sum of block weights, -1 if unknown
+
+    int analyze();
+    bool is_contended(int bbid) const;
+    SchedEngine choose(int bbid) const;
+
+   public:
+    int max_exact_ops = 64;   // larger blocks are exact only if hot
+    float hot_ratio = 0.05;   // hot blocks weigh more than this share
+    std::ostream *log = nullptr;  // optional, log choice of each block
+
+    AdaptiveScheduler(const HLSInput &hin, const HLSOutput &hout, bool rlimit)
+        : SDCScheduler(hin, hout, rlimit), list(hin, hout, rlimit) {
+        engines.resize(n_block, ENGINE_ASAP);
+        times.resize(n_block, 0);
+    }
+
+    int schedule_block(int bbid, map<int, int> &res);
+
+    void print() const;  // summary of blocks and time of each engine
+};
+
+}  // namespace hls
+
+#endif
@@ -2,6 +2,23 @@
 
 namespace hls {
 
+const AdjacentList &BaseScheduler::get_induced_graph(int bbid,
+                                                     AdjacentList &buf) const {
+    if (cache) return cache->graphs[bbid];
+    buf = build_induced_graph(bbid, *hin);
+    return buf;
+}
+
+int BaseScheduler::get_rtid(int opid) const {
+    int rtid = op2rtid[opid];
+    return rtid != -1 ? rtid : ot2rtid[hin->operations[opid].optype];
+}
+
+int BaseScheduler::get_latency(int opid) const {
+    int rtid = get_rtid(opid);
+    return rtid == -1 ? 0 : hin->resource_types[rtid].latency;
+}
+
 // Give an order to schedule basic block
 vector<int> BaseScheduler::sort_basic_block() {
     vector<int> order;
@@ -68,19 +85,22 @@ int BaseScheduler::schedule_block(int bbid, map<int, int> &res) {
     const auto &bb = hin->blocks[bbid];
     res.empty();
 
-    // build induced graph
-    AdjacentList list = build_induced_graph(bbid, *hin);
-
     // schedule according to topology sort
     vector<int> topo;
-    if (topology_sort(list, topo) != 0) {
+    int ret;
+    if (cache) {
+        topo = cache->topos[bbid];
+        ret = (topo.size() == cache->graphs[bbid].size()) ? 0 : -1;
+    } else {
+        ret = topology_sort(build_induced_graph(bbid, *hin), topo);
+    }
+    if (ret != 0) {
         std::cerr << "Error in topology sort!" << std::endl;
         return -1;
     }
 
     int l = 0;
     for (auto opid : topo) {
-        const auto &op = hin->operations[opid];
         OpCategory opcate = hin->get_opcate(opid);
         if (opcate == OP_ALLOCA || opcate == OP_BRANCH || opcate == OP_PHI)
             res.insert(std::make_pair(opid, -1));
@@ -88,19 +108,18 @@ int BaseScheduler::schedule_block(int bbid, map<int, int> &res) {
             res.insert(std::make_pair(opid, l));
 
         // update l
-        int rtid = ot2rtid[op.optype];
-        int latency = hin->resource_types[rtid].latency;
-        l += latency + 1;  // result must have been ready by now
+        l += get_latency(opid) + 1;  // result must have been ready by now
     }
     return l;
 }
 
 // Schedule all operations
-// Returns 0 on success, -1 on errors.
+// Returns 0 on success, 1 on cancellation, -1 on errors.
 int BaseScheduler::schedule() {
-    vector<int> order = sort_basic_block();
+    order = sort_basic_block();
     int start = 1;
     int lasting;
+    float partial = 0;  // weighted latency of scheduled blocks
     if (order.size() != n_block) {
         std::cerr << "Error: Base Scheduler sort blocks " << std::endl;
         for (auto bbid : order) std::cerr << bbid << ' ';
@@ -122,7 +141,129 @@ int BaseScheduler::schedule() {
             scheds[opid] = (cycle == -1 ? 0 : start) + cycle;
         }
         start += lasting;
+        bb_lens[bbid] = lasting;
+        bb_scheds[bbid] = bb_sched;
+        update_usage(bbid);
+
+        // ops may not start from cycle 0, see HLSOutput::get_block_range
+        if (should_stop) {
+            int first = lasting;
+            for (auto it = bb_sched.begin(); it != bb_sched.end(); it++)
+                if (it->second != -1) first = std::min(first, it->second);
+            partial += (lasting - first) * hin->blocks[bbid].exp_times;
+            if (should_stop(partial)) return 1;
+        }
+    }
+    return 0;
+}
+
+// Count the peak num of ops occupying each resource type,
+// given cycles of ops in a block
+map<int, int> BaseScheduler::get_usage(const map<int, int> &bb_sched) const {
+    map<int, map<int, int>> deltas;  // rtid -> (cycle -> usage change)
+    for (const auto &it : bb_sched) {
+        if (it.second == -1) continue;
+        int rtid = get_rtid(it.first);
+        if (rtid == -1) continue;
+        int occupancy = get_occupancy(hin->resource_types[rtid]);
+        deltas[rtid][it.second]++;
+        deltas[rtid][it.second + occupancy]--;
+    }
+
+    map<int, int> usage;
+    for (const auto &rt_it : deltas) {
+        int now = 0, peak = 0;
+        for (const auto &it : rt_it.second) {
+            now += it.second;
+            peak = std::max(peak, now);
+        }
+        usage[rt_it.first] = peak;
+    }
+    return usage;
+}
+
+void BaseScheduler::update_usage(int bbid) {
+    bb_usage[bbid] = get_usage(bb_scheds[bbid]);
+}
+
+// Schedule ops of a block as soon as possible, ignoring resources.
+// Returns num of cycles on success, -1 on errors.
+int BaseScheduler::schedule_asap(int bbid, map<int, int> &res) const {
+    AdjacentList buf;
+    const AdjacentList &g = get_induced_graph(bbid, buf);
+    vector<int> topo;
+    if (cache) {
+        topo = cache->topos[bbid];
+    } else if (topology_sort(g, topo) < 0) {
+        std::cerr << "Error in topology sort!" << std::endl;
+        return -1;
+    }
+
+    map<int, int> earliest;
+    int l = 0;
+    for (auto opid : topo) {
+        if (!hin->need_schedule(hin->get_opcate(opid))) {
+            res[opid] = -1;
+            continue;
+        }
+        int cycle = earliest[opid];
+        res[opid] = cycle;
+        int ready = cycle + get_latency(opid) + 1;
+        l = std::max(l, ready);
+        for (auto out : g.at(opid).second)
+            earliest[out] = std::max(earliest[out], ready);
+    }
+    return l;
+}
+
+void BaseScheduler::layout() {
+    int start = 1;
+    for (auto bbid : order) {
+        for (const auto &it : bb_scheds[bbid]) {
+            int cycle = it.second;
+            scheds[it.first] = (cycle == -1 ? 0 : start) + cycle;
+        }
+        start += bb_lens[bbid];
+    }
+}
+
+vector<int> BaseScheduler::get_dirty_blocks() const {
+    vector<int> dirty;
+    for (auto bbid : order) {
+        for (const auto &it : bb_usage[bbid]) {
+            int k = rinsts[it.first];
+            if (k > 0 && it.second > k) {
+                dirty.push_back(bbid);
+                break;
+            }
+        }
+    }
+    return dirty;
+}
+
+void BaseScheduler::set_block(int bbid, const map<int, int> &bb_sched,
+                              int lasting) {
+    bb_lens[bbid] = lasting;
+    bb_scheds[bbid] = bb_sched;
+    update_usage(bbid);
+}
+
+int BaseScheduler::reschedule(const vector<int> &bbids) {
+    if (order.empty()) order = sort_basic_block();
+    if (order.size() != n_block) {
+        std::cerr << "Error: Base Scheduler sort blocks " << std::endl;
+        return -1;
+    }
+    for (auto bbid : bbids) {
+        map<int, int> bb_sched;
+        int lasting = schedule_block(bbid, bb_sched);
+        if (lasting < 0) {
+            std::cerr << "Error: Rescheduling block " << bbid << std::endl;
+            return -1;
+        }
+        set_block(bbid, bb_sched, lasting);
     }
+    layout();
     return 0;
 }
 
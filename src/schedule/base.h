@@ -1,12 +1,14 @@
 #ifndef HLS_SCHEDULE_BASE_H
 #define HLS_SCHEDULE_BASE_H
 
+#include <functional>
 #include <queue>
 #include <set>
 #include <vector>
 
 #include "io.h"
 #include "graph.h"
+#include "reservation.h"
 
 using std::map;
 using std::queue;
@@ -15,8 +17,13 @@ using std::vector;
 
 namespace hls {
 
+// Polled with a lower bound of weighted latency, returns true to cancel
+typedef std::function<bool(float)> StopHook;
+
 // Basic scheduler
 // Schedule one basic block at a time and give a worst linear scheduling.
+// Allocation is viewed from hout without copying, so the scheduler sees
+// later changes on hout's insts.
 class BaseScheduler {
    protected:
     int n_block;
@@ -24,30 +31,69 @@ class BaseScheduler {
     int n_op_type;
     int n_resource_type;
     const HLSInput *hin;
-    vector<int> ot2rtid;
-    vector<int> insts;
-    vector<int> rinsts;
+    const vector<int> &ot2rtid;
+    const vector<int> &op2rtid;
+    const vector<int> &insts;
+    const vector<int> &rinsts;
     vector<int> scheds;
 
+    // Kept from the last run, for rescheduling some blocks only
+    vector<int> order;                // order of blocks
+    vector<map<int, int>> bb_scheds;  // bbid -> (opid -> cycle in block)
+    vector<int> bb_lens;              // bbid -> num of cycles
+    vector<map<int, int>> bb_usage;   // bbid -> (rtid -> peak usage)
+
+    int get_rtid(int opid) const;     // as HLSOutput::get_rtid
+    int get_latency(int opid) const;  // 0 if op has no resource type
+
+    // Induced graph of a block, from cache if any, otherwise built in buf
+    const AdjacentList &get_induced_graph(int bbid, AdjacentList &buf) const;
+
+    map<int, int> get_usage(const map<int, int> &bb_sched) const;
+    void update_usage(int bbid);
+    int schedule_asap(int bbid, map<int, int> &res) const;
+    void layout();  // place blocks one after another
+
    public:
-    BaseScheduler(const HLSInput &hin, const HLSOutput &hout) {
+    StopHook should_stop;             // optional, polled after each block
+    const CDFGCache *cache = nullptr;  // optional, shared induced graphs
+
+    BaseScheduler(const HLSInput &hin, const HLSOutput &hout)
+        : ot2rtid(hout.ot2rtid),
+          op2rtid(hout.op2rtid),
+          insts(hout.insts),
+          rinsts(hout.rinsts) {
         n_block = hin.n_block;
         n_operation = hin.n_operation;
         n_op_type = hin.n_op_type;
         n_resource_type = hin.n_resource_type;
         this->hin = &hin;
-        ot2rtid = vector<int>(hout.ot2rtid);
-        insts = vector<int>(hout.insts);
-        rinsts = vector<int>(hout.rinsts);
         scheds.resize(n_operation, 0);
+        bb_scheds.resize(n_block);
+        bb_lens.resize(n_block, 0);
+        bb_usage.resize(n_block);
     }
 
     vector<int> sort_basic_block();
 
     virtual int schedule_block(int bbid, map<int, int> &res);
 
+    // Returns 0 on success, 1 on cancellation, -1 on errors.
     int schedule();
 
+    // Blocks whose peak usage of some resource type exceeds current rinsts,
+    // after rinsts are cut down.
+    vector<int> get_dirty_blocks() const;
+
+    // Solve the given blocks again, keeping the others' schedule.
+    // Blocks not yet scheduled must have been set beforehand.
+    // Returns 0 on success, -1 on errors.
+    int reschedule(const vector<int> &bbids);
+
+    // Take a known schedule of a block, as cycles in the block,
+    // instead of solving it
+    void set_block(int bbid, const map<int, int> &bb_sched, int lasting);
+
     void copyout(HLSOutput &hout);
 };
 
@@ -0,0 +1,119 @@
+#include "compact.h"
+
+#include <algorithm>
+
+#include "reservation.h"
+
+namespace hls {
+
+// Returns num of ops moved earlier in the block.
+int Compactor::compact_block(int bbid) {
+    const auto &bb = hin->blocks[bbid];
+    int start = -1;
+    for (auto opid : bb.ops) {
+        if (scheds[opid] < 0) continue;
+        start = (start == -1) ? scheds[opid] : std::min(start, scheds[opid]);
+    }
+    if (start == -1) return 0;
+
+    // insts taken at cycles relative to block start
+    ReservationTable table(*hin, hout->rinsts);
+    auto get_rtid = [this](int opid) { return hout->get_rtid(opid); };
+
+    vector<int> ops;
+    for (auto opid : bb.ops) {
+        if (scheds[opid] < 0) continue;
+        ops.push_back(opid);
+        if (binds[opid] >= 0)
+            table.reserve_inst(get_rtid(opid), binds[opid],
+                               scheds[opid] - start);
+    }
+
+    int n_moved = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        std::sort(ops.begin(), ops.end(), [this](int a, int b) {
+            return scheds[a] < scheds[b] || (scheds[a] == scheds[b] && a < b);
+        });
+        for (auto opid : ops) {
+            // earliest cycle after preds in block, chaining not allowed
+            int lo = start;
+            const auto &op = hin->operations[opid];
+            for (auto in : op.inputs) {
+                if (in < 0 || hin->operations[in].bbid != bbid ||
+                    scheds[in] < 0)
+                    continue;
+                lo = std::max(lo, scheds[in] + hout->get_latency(in) + 1);
+            }
+            if (lo >= scheds[opid]) continue;
+
+            int old_cycle = scheds[opid];
+            if (binds[opid] < 0) {
+                scheds[opid] = lo;
+            } else {
+                // take the first free slot, preferring the inst it has
+                int rtid = get_rtid(opid);
+                table.release_inst(rtid, binds[opid], old_cycle - start);
+                for (int c = lo; c < old_cycle; c++) {
+                    int inst = binds[opid];
+                    if (!table.is_inst_free(rtid, inst, c - start))
+                        inst = table.first_free_inst(rtid, c - start);
+                    if (inst != -1) {
+                        scheds[opid] = c;
+                        binds[opid] = inst;
+                        break;
+                    }
+                }
+                table.reserve_inst(rtid, binds[opid], scheds[opid] - start);
+            }
+            if (scheds[opid] == old_cycle) continue;
+            n_moved++;
+            changed = true;
+        }
+    }
+    return n_moved;
+}
+
+// Place blocks one after another in their original order, without gaps
+void Compactor::layout() {
+    vector<pair<int, int>> ranges;  // (start, bbid)
+    vector<int> starts(hin->n_block, -1), ends(hin->n_block, -1);
+    for (const auto &bb : hin->blocks) {
+        for (auto opid : bb.ops) {
+            if (scheds[opid] < 0) continue;
+            int op_end = scheds[opid] + hout->get_latency(opid) + 1;
+            if (starts[bb.bbid] == -1 || scheds[opid] < starts[bb.bbid])
+                starts[bb.bbid] = scheds[opid];
+            ends[bb.bbid] = std::max(ends[bb.bbid], op_end);
+        }
+        if (starts[bb.bbid] != -1)
+            ranges.push_back(std::make_pair(starts[bb.bbid], bb.bbid));
+    }
+    if (ranges.empty()) return;
+    std::sort(ranges.begin(), ranges.end());
+
+    int now = ranges[0].first;
+    for (const auto &range : ranges) {
+        int bbid = range.second;
+        int shift = starts[bbid] - now;
+        for (auto opid : hin->blocks[bbid].ops)
+            if (scheds[opid] >= 0) scheds[opid] -= shift;
+        now += ends[bbid] - starts[bbid];
+    }
+}
+
+int Compactor::compact() {
+    int n_moved = 0;
+    for (int bbid = 0; bbid < hin->n_block; bbid++)
+        n_moved += compact_block(bbid);
+    layout();
+    return n_moved;
+}
+
+void Compactor::copyout(HLSOutput &hout) {
+    hout.scheds = scheds;
+    hout.binds = binds;
+}
+
+}  // namespace hls
@@ -0,0 +1,46 @@
+#ifndef HLS_SCHEDULE_COMPACT_H
+#define HLS_SCHEDULE_COMPACT_H
+
+#include <vector>
+
+#include "io.h"
+
+using std::vector;
+
+namespace hls {
+
+// Compaction post-pass on a bound schedule
+// Resource constraints of SDC serialize ops in a fixed order, leaving free
+// slots on insts. Move each op to its earliest cycle after its preds where
+// its own inst or another inst of its resource type is free, rebinding it
+// if needed, until nothing moves. Then shrink blocks and shift later ones.
+// Insts in use never grow, so the binding stays valid without any LP.
+class Compactor {
+   private:
+    const HLSInput *hin;
+    const HLSOutput *hout;
+    int n_operation;
+
+    int compact_block(int bbid);
+    void layout();
+
+   public:
+    vector<int> scheds;
+    vector<int> binds;
+
+    Compactor(const HLSInput &hin, const HLSOutput &hout)
+        : scheds(hout.scheds), binds(hout.binds) {
+        this->hin = &hin;
+        this->hout = &hout;
+        this->n_operation = hin.n_operation;
+    }
+
+    // Returns num of ops moved earlier.
+    int compact();
+
+    void copyout(HLSOutput &hout);
+};
+
+}  // namespace hls
+
+#endif
@@ -0,0 +1,78 @@
+#include "list.h"
+
+namespace hls {
+
+// Schedule a block from cycle 0 and write to res
+// return num of cycles on success, -1 on errors
+int ListScheduler::schedule_block(int bbid, map<int, int> &res) {
+    AdjacentList buf;
+    const AdjacentList &g = get_induced_graph(bbid, buf);
+    vector<int> topo;
+    if (cache) {
+        topo = cache->topos[bbid];
+    } else if (topology_sort(g, topo) < 0) {
+        std::cerr << "Error in topology sort!" << std::endl;
+        return -1;
+    }
+
+    // priority: longest path from an op to the end of block
+    map<int, int> height, n_wait, earliest;
+    for (auto it = topo.rbegin(); it != topo.rend(); it++) {
+        int opid = *it;
+        if (!hin->need_schedule(hin->get_opcate(opid))) continue;
+        int h = 0;
+        for (auto out : g.at(opid).second) {
+            if (!hin->need_schedule(hin->get_opcate(out))) continue;
+            h = std::max(h, height[out]);
+            n_wait[out]++;
+        }
+        height[opid] = h + get_latency(opid) + 1;
+    }
+
+    // ready ops as (-height, opid)
+    set<pair<int, int>> ready;
+    int n_left = 0;
+    for (auto opid : topo) {
+        if (!hin->need_schedule(hin->get_opcate(opid))) {
+            res[opid] = -1;
+            continue;
+        }
+        n_left++;
+        if (n_wait[opid] == 0)
+            ready.insert(std::make_pair(-height[opid], opid));
+    }
+
+    // insts of each resource type, no limit if rlimit is off
+    vector<int> capacity = rlimit ? rinsts : vector<int>(n_resource_type, 0);
+    ReservationTable table(*hin, capacity);
+    int l = 0;
+    for (int cycle = 0; n_left > 0; cycle++) {
+        vector<int> started;
+        for (const auto &node : ready) {
+            int opid = node.second;
+            if (earliest[opid] > cycle) continue;
+            int rtid = get_rtid(opid);
+            if (!table.is_free(rtid, cycle)) continue;
+            table.reserve(rtid, cycle);
+            res[opid] = cycle;
+            started.push_back(opid);
+            l = std::max(l, cycle + get_latency(opid) + 1);
+        }
+
+        // release successors of started ops
+        for (auto opid : started) {
+            ready.erase(std::make_pair(-height[opid], opid));
+            n_left--;
+            int finish = cycle + get_latency(opid) + 1;
+            for (auto out : g.at(opid).second) {
+                if (!hin->need_schedule(hin->get_opcate(out))) continue;
+                earliest[out] = std::max(earliest[out], finish);
+                if (--n_wait[out] == 0)
+                    ready.insert(std::make_pair(-height[out], out));
+            }
+        }
+    }
+    return l;
+}
+
+}  // namespace hls
@@ -0,0 +1,27 @@
+#ifndef HLS_SCHEDULE_LIST_H
+#define HLS_SCHEDULE_LIST_H
+
+#include "base.h"
+#include "io.h"
+
+namespace hls {
+
+// Resource constrained list scheduler
+// Fill cycles one by one with ready ops, taking those with the longest
+// path to the end of block first, while insts of their resource types
+// are free. Runs in near linear time, for blocks too large for an LP.
+class ListScheduler : public BaseScheduler {
+   public:
+    bool rlimit = false;  // limit concurrent ops by rinsts or not
+
+    ListScheduler(const HLSInput &hin, const HLSOutput &hout, bool rlimit)
+        : BaseScheduler(hin, hout) {
+        this->rlimit = rlimit;
+    }
+
+    int schedule_block(int bbid, map<int, int> &res);
+};
+
+}  // namespace hls
+
+#endif
@@ -7,14 +7,6 @@ using std::endl;
 
 namespace hls {
 
-static inline int get_latency(const vector<int> &ot2rtid, const HLSInput *hin,
-                              int opid) {
-    const auto &op = hin->operations[opid];
-    auto rtid = ot2rtid[op.optype];
-    const auto &rt = hin->resource_types[rtid];
-    return rt.latency;
-}
-
 int SDCScheduler::schedule_block(int bbid, map<int, int> &res) {
     const auto &bb = hin->blocks[bbid];
     int *colno = new int[bb.n_op_in_block + 1];  // ordered by bb.ops
@@ -67,7 +59,7 @@ int SDCScheduler::schedule_block(int bbid, map<int, int> &res) {
             auto opcate = hin->get_opcate(op);
             if (hin->need_schedule(opcate)) {
                 res.insert(std::make_pair(op, cycle));
-                int latency = get_latency(ot2rtid, hin, op);
+                int latency = get_latency(op);
                 max_cycle = std::max(max_cycle, cycle + latency + 1);
             } else {
                 res.insert(std::make_pair(op, -1));
@@ -97,7 +89,8 @@ int SDCScheduler::add_constraints(int bbid, lprec *lp) {
     REAL *row = new REAL[bb.n_op_in_block];
     int ret = 0;
 
-    AdjacentList g = build_induced_graph(bbid, *hin);
+    AdjacentList buf;
+    const AdjacentList &g = get_induced_graph(bbid, buf);
 
     // Dependence constraints & Optimization constraints
     for (auto it = g.begin(); it != g.end(); it++) {
@@ -119,7 +112,7 @@ int SDCScheduler::add_constraints(int bbid, lprec *lp) {
                 colno[1] = op2idx[opid] + 1;
                 row[0] = 1;
                 row[1] = -1;
-                int latency = get_latency(ot2rtid, hin, opid);
+                int latency = get_latency(opid);
                 // Notice that chaining is not allowed now
                 if (!add_constraintex(lp, 2, row, colno, GE, latency + 1))
                     ret = -1;
@@ -133,7 +126,7 @@ int SDCScheduler::add_constraints(int bbid, lprec *lp) {
             colno[1] = bb.n_op_in_block + 1;
             row[0] = 1;
             row[1] = -1;
-            int latency = get_latency(ot2rtid, hin, opid);
+            int latency = get_latency(opid);
             if (!add_constraintex(lp, 2, row, colno, LE, 0)) ret = -1;
         }
     }
@@ -141,7 +134,9 @@ int SDCScheduler::add_constraints(int bbid, lprec *lp) {
     // Resource constraints
     vector<vector<int>> topos;
     if (rlimit) {
-        if (topology_sort(g, *hin, ot2rtid, topos) < 0) {
+        if (topology_sort(g, *hin,
+                          [this](int opid) { return get_rtid(opid); },
+                          topos) < 0) {
             cerr << "Error in SDC topology sorting!" << endl;
             ret = -1;
         }
@@ -154,17 +149,8 @@ int SDCScheduler::add_constraints(int bbid, lprec *lp) {
             // Load and store will be ignored here.
             if (k <= 0) continue;
 
-            // get resource's latency
-            const auto &rt = hin->resource_types[rtid];
-            int latency;
-            if (rt.is_sequential) {
-                if (rt.is_pipelined)
-                    latency = 1;
-                else
-                    latency = rt.latency + 1;  // still has delay!
-            } else {
-                latency = 1;  // otherwise combinational ops will conflict
-            }
+            // cycles an op occupies the resource
+            int latency = get_occupancy(hin->resource_types[rtid]);
 
             // add constraints on interval of k
             for (int i = k; i < topo.size(); i++) {
@@ -0,0 +1,161 @@
+#include "balance.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+
+#include "reservation.h"
+
+namespace hls {
+
+// A two-input op of the optype
+bool TreeBalancer::is_node(int opid, int optype) const {
+    const auto &op = hin->operations[opid];
+    return op.optype == optype && op.n_inputs == 2;
+}
+
+// A node only used by a node of its optype in its block
+bool TreeBalancer::is_inner(int opid) const {
+    const auto &op = hin->operations[opid];
+    int parent = parents[opid];
+    if (parent < 0 || !is_node(opid, op.optype)) return false;
+    return hin->operations[parent].bbid == op.bbid &&
+           is_node(parent, op.optype);
+}
+
+void TreeBalancer::collect(int opid, ExprTree &tree) const {
+    for (auto in : hin->operations[opid].inputs) {
+        if (in >= 0 && is_inner(in))
+            collect(in, tree);
+        else
+            tree.leaves.push_back(in);
+    }
+    tree.nodes.push_back(opid);
+}
+
+// Estimated cycle each op in a block is ready, ignoring resources
+map<int, int> TreeBalancer::get_ready(int bbid) const {
+    map<int, int> ready;
+    std::function<int(int)> get = [&](int opid) {
+        auto it = ready.find(opid);
+        if (it != ready.end()) return it->second;
+        const auto &op = hin->operations[opid];
+        if (!hin->need_schedule(hin->get_opcate(opid)))
+            return ready[opid] = 0;
+        int start = 0;
+        for (auto in : op.inputs) {
+            if (in < 0 || hin->operations[in].bbid != bbid) continue;
+            if (hin->get_opcate(in) == OP_PHI) continue;
+            start = std::max(start, get(in));
+        }
+        return ready[opid] = start + lats[op.optype] + 1;
+    };
+    for (auto opid : hin->blocks[bbid].ops) get(opid);
+    return ready;
+}
+
+// Combine operands into a tree, with nodes of the tree in order.
+// Writes new inputs to the balanced input if apply is set.
+void TreeBalancer::rebuild(ExprTree &tree, const map<int, int> &ready,
+                           bool apply) {
+    int optype = hin->operations[tree.root].optype;
+    bool commutative = hin->is_commutative(optype);
+    vector<pair<int, int>> operands;  // (cycle ready, opid)
+    for (auto leaf : tree.leaves) {
+        auto it = ready.find(leaf);
+        operands.push_back(
+            std::make_pair(it == ready.end() ? 0 : it->second, leaf));
+    }
+    // free cycles of insts
+    priority_queue<int, vector<int>, std::greater<int>> units;
+    for (int i = 0; i < widths[optype]; i++) units.push(0);
+
+    int k = 0;
+    while (operands.size() > 1) {
+        // the pair of operands ready first
+        int i = 0, j = 1;
+        for (int a = 0; a < operands.size(); a++) {
+            for (int b = a + 1; b < operands.size(); b++) {
+                if (!commutative && b != a + 1) break;
+                int now = std::max(operands[a].first, operands[b].first);
+                if (now < std::max(operands[i].first, operands[j].first)) {
+                    i = a;
+                    j = b;
+                }
+            }
+        }
+
+        int start = std::max({operands[i].first, operands[j].first,
+                              units.top()});
+        units.pop();
+        units.push(start + occs[optype]);
+        int node = tree.nodes[k++];
+        if (apply) {
+            auto &op = balanced.operations[node];
+            op.inputs = {operands[i].second, operands[j].second};
+        }
+        operands[i] = std::make_pair(start + lats[optype] + 1, node);
+        operands.erase(operands.begin() + j);
+    }
+    tree.new_height = operands[0].first;
+}
+
+int TreeBalancer::balance() {
+    parents.assign(hin->n_operation, -1);
+    for (const auto &op : hin->operations) {
+        for (auto in : op.inputs) {
+            if (in < 0) continue;
+            parents[in] = (parents[in] == -1) ? op.opid : -2;
+        }
+    }
+
+    lats.assign(hin->n_op_type, INT_MAX);
+    occs.assign(hin->n_op_type, 1);
+    widths.assign(hin->n_op_type, 1);
+    for (const auto &rt : hin->resource_types) {
+        int width = rt.area > 0 ? hin->area_limit / rt.area : INT_MAX;
+        for (auto ot : rt.comp_ops) {
+            if (rt.latency < lats[ot]) {
+                lats[ot] = rt.latency;
+                occs[ot] = get_occupancy(rt);
+            }
+            widths[ot] = std::max(widths[ot], std::min(width, 1 << 16));
+        }
+    }
+    for (auto &lat : lats)
+        if (lat == INT_MAX) lat = 0;
+
+    for (int bbid = 0; bbid < hin->n_block; bbid++) {
+        map<int, int> ready;
+        for (auto opid : hin->blocks[bbid].ops) {
+            const auto &op = hin->operations[opid];
+            auto opcate = hin->get_opcate(opid);
+            if (opcate != OP_ARITHM && opcate != OP_BOOL) continue;
+            if (!hin->is_associative(op.optype)) continue;
+            if (!is_node(opid, op.optype) || is_inner(opid)) continue;
+
+            ExprTree tree;
+            tree.root = opid;
+            collect(opid, tree);
+            if (tree.nodes.size() < 3) continue;
+            if (ready.empty()) ready = get_ready(bbid);
+            tree.old_height = ready[opid];
+            rebuild(tree, ready, false);
+            if (tree.new_height >= tree.old_height) continue;
+            rebuild(tree, ready, true);
+            trees.push_back(tree);
+        }
+    }
+    return trees.size();
+}
+
+void TreeBalancer::print() const {
+    cerr << "Tree Balancer: regrouped " << trees.size() << " trees" << endl;
+    for (const auto &tree : trees) {
+        cerr << "  op " << tree.root << ": " << tree.leaves.size()
+             << " operands, ready at " << tree.old_height << " -> "
+             << tree.new_height << endl;
+    }
+}
+
+}  // namespace hls
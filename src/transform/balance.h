@@ -0,0 +1,56 @@
+#ifndef HLS_TRANSFORM_BALANCE_H
+#define HLS_TRANSFORM_BALANCE_H
+
+#include <vector>
+
+#include "io.h"
+
+using std::vector;
+
+namespace hls {
+
+// An expression tree of one associative optype in a block, whose inner
+// nodes are only used by their parents
+struct ExprTree {
+    int root;
+    vector<int> leaves;  // operands from left to right, opid or -1
+    vector<int> nodes;   // ops of the tree, root at last
+    int old_height;      // estimated cycle the root is ready
+    int new_height;
+};
+
+// Tree-height reduction of associative ops.
+// Chains like ((a + b) + c) + d are regrouped into trees, combining the
+// operands ready earliest first (or adjacent ones, if not commutative),
+// while at most as many nodes run at once as insts the area limit affords.
+// Ops of a tree are reused for its new nodes, so op ids are kept, but
+// dependencies change: results are valid on the balanced input only.
+class TreeBalancer {
+   private:
+    const HLSInput *hin;
+    HLSInput balanced;
+    vector<int> parents;  // opid -> the op reading it, -2 if many
+    vector<int> lats;     // optype -> latency of the fastest type
+    vector<int> occs;     // optype -> occupancy of the fastest type
+    vector<int> widths;   // optype -> max insts within the area limit
+    vector<ExprTree> trees;
+
+    bool is_node(int opid, int optype) const;
+    bool is_inner(int opid) const;
+    void collect(int opid, ExprTree &tree) const;
+    map<int, int> get_ready(int bbid) const;
+    void rebuild(ExprTree &tree, const map<int, int> &ready, bool apply);
+
+   public:
+    TreeBalancer(const HLSInput &hin) : balanced(hin) { this->hin = &hin; }
+
+    // Returns the number of regrouped trees.
+    int balance();
+
+    const HLSInput &get_balanced() const { return balanced; }
+    void print() const;
+};
+
+}  // namespace hls
+
+#endif
@@ -0,0 +1,211 @@
+#include "ifconv.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <sstream>
+
+namespace hls {
+
+// Match head -> {t, f} -> join on the converted CFG, where both sides are
+// only reached from the head, small enough and free of memory accesses, and
+// a join to merge has no PHIs unless the head branches on a condition.
+bool IfConverter::match_diamond(int bbid, Diamond &d) const {
+    const auto &blocks = converted.blocks;
+    const auto &head = blocks[bbid];
+    if (head.n_succ != 2 || head.succs[0] == head.succs[1]) return false;
+    int t = head.succs[0], f = head.succs[1];
+    for (auto side : {t, f}) {
+        const auto &bb = blocks[side];
+        if (side == bbid || bb.n_pred != 1 || bb.n_succ != 1) return false;
+        for (auto opid : bb.ops) {
+            auto opcate = converted.get_opcate(opid);
+            if (opcate == OP_LOAD || opcate == OP_STORE) return false;
+        }
+    }
+    int join = blocks[t].succs[0];
+    if (blocks[f].succs[0] != join) return false;
+    if (join == bbid || join == t || join == f) return false;
+    if (blocks[t].n_op_in_block + blocks[f].n_op_in_block > max_ops)
+        return false;
+
+    d.head = bbid;
+    d.t = t;
+    d.f = f;
+    d.join = join;
+    d.merged_join = (blocks[join].n_pred == 2);
+
+    // PHIs of a merged join need the condition to select on
+    if (d.merged_join && get_cond(bbid) == -1)
+        for (auto opid : blocks[join].ops)
+            if (converted.get_opcate(opid) == OP_PHI) return false;
+    return true;
+}
+
+// Branch condition of the head, or -1
+int IfConverter::get_cond(int head) const {
+    for (auto opid : hin->blocks[head].ops) {
+        const auto &op = hin->operations[opid];
+        if (hin->get_opcate(opid) == OP_BRANCH && !op.inputs.empty())
+            return op.inputs[0];
+    }
+    return -1;
+}
+
+// Add the select op type and a mux type for it on first use
+int IfConverter::get_select_type() {
+    if (sel_type != -1) return sel_type;
+    sel_type = converted.n_op_type++;
+    converted.op_types.push_back(OP_ARITHM);
+    converted.op_attrs.push_back(0);
+    min_lats.push_back(0);
+
+    // combinational, area, delay, compatible op types
+    int area = std::max(converted.reg_area, 1);
+    std::istringstream sin("0 " + std::to_string(area) + " 0 1 " +
+                           std::to_string(sel_type));
+    ResourceType mux(sin);
+    mux.rtid = converted.n_resource_type++;
+    converted.resource_types.push_back(mux);
+    return sel_type;
+}
+
+// Longest path through ops in cycles, ignoring resources.
+// PHIs of the join are taken as selects, waiting for the condition too.
+int IfConverter::get_path_length(const vector<int> &ops, int join,
+                                 int cond) const {
+    std::set<int> in_set(ops.begin(), ops.end());
+    map<int, int> finish;  // opid -> cycle its result is ready
+    std::function<int(int)> get_finish = [&](int opid) {
+        auto it = finish.find(opid);
+        if (it != finish.end()) return it->second;
+        auto opcate = converted.get_opcate(opid);
+        if (!converted.need_schedule(opcate)) return finish[opid] = 0;
+
+        int start = 0;
+        for (auto in : converted.operations[opid].inputs) {
+            if (!in_set.count(in)) continue;
+            const auto &in_op = converted.operations[in];
+            if (converted.get_opcate(in) != OP_PHI) {
+                start = std::max(start, get_finish(in));
+            } else if (in_op.bbid == join) {
+                int ready = in_set.count(cond) ? get_finish(cond) : 0;
+                for (auto sel : in_op.inputs)
+                    if (in_set.count(sel))
+                        ready = std::max(ready, get_finish(sel));
+                start = std::max(start, ready + 1);
+            }
+        }
+        int optype = converted.operations[opid].optype;
+        return finish[opid] = start + min_lats[optype] + 1;
+    };
+
+    int l = 0;
+    for (auto opid : ops) l = std::max(l, get_finish(opid));
+    return l;
+}
+
+// Merge if the expected cycles don't grow, assuming enough resources.
+bool IfConverter::is_profitable(const Diamond &d) const {
+    const auto &blocks = converted.blocks;
+    int target = host[d.head];
+    vector<int> parts = {target, d.t, d.f};
+    if (d.merged_join) parts.push_back(d.join);
+
+    float before = 0;
+    vector<int> ops;
+    for (auto bbid : parts) {
+        const auto &bb = blocks[bbid];
+        before += get_path_length(bb.ops, -1, -1) * bb.exp_times;
+        ops.insert(ops.end(), bb.ops.begin(), bb.ops.end());
+    }
+    int join = d.merged_join ? d.join : -1;
+    float after = get_path_length(ops, join, get_cond(d.head)) *
+                  blocks[target].exp_times;
+    return after < before;
+}
+
+void IfConverter::merge(const Diamond &d) {
+    auto &blocks = converted.blocks;
+    auto &operations = converted.operations;
+    int target = host[d.head];
+    auto &bb = blocks[target];
+    vector<int> join_ops = blocks[d.join].ops;
+
+    // move ops into the target block, every op now runs as often as it
+    vector<int> parts = {d.t, d.f};
+    if (d.merged_join) parts.push_back(d.join);
+    for (auto bbid : parts) {
+        auto &part = blocks[bbid];
+        for (auto opid : part.ops) {
+            bb.ops.push_back(opid);
+            operations[opid].bbid = target;
+        }
+        part.ops.clear();
+        part.n_op_in_block = 0;
+        part.exp_times = 0;
+        host[bbid] = target;
+    }
+    bb.n_op_in_block = bb.ops.size();
+
+    // chain emptied blocks after the head: head -> t -> f -> join
+    auto &head = blocks[d.head];
+    head.succs = {d.t};
+    head.n_succ = 1;
+    blocks[d.t].succs = {d.f};
+    blocks[d.f].preds = {d.t};
+    auto &preds = blocks[d.join].preds;
+    preds.erase(std::remove(preds.begin(), preds.end(), d.t), preds.end());
+    blocks[d.join].n_pred = preds.size();
+
+    if (!d.merged_join) return;
+
+    // PHIs of the join become selects on the condition, users unchanged
+    int cond = get_cond(d.head);
+    for (auto opid : join_ops) {
+        if (converted.get_opcate(opid) != OP_PHI) continue;
+        auto &op = operations[opid];
+        op.optype = get_select_type();
+        op.inputs.insert(op.inputs.begin(), cond);
+        op.n_inputs = op.inputs.size();
+        n_select++;
+    }
+}
+
+int IfConverter::convert() {
+    host.resize(hin->n_block);
+    std::iota(host.begin(), host.end(), 0);
+    min_lats.assign(hin->n_op_type, std::numeric_limits<int>::max());
+    for (const auto &rt : hin->resource_types)
+        for (auto ot : rt.comp_ops)
+            min_lats[ot] = std::min(min_lats[ot], rt.latency);
+    for (auto &lat : min_lats)
+        if (lat == std::numeric_limits<int>::max()) lat = 0;
+
+    // a merged join may head another diamond, so run until no change
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int bbid = 0; bbid < hin->n_block; bbid++) {
+            Diamond d;
+            if (!match_diamond(bbid, d) || !is_profitable(d)) continue;
+            merge(d);
+            diamonds.push_back(d);
+            changed = true;
+        }
+    }
+    return diamonds.size();
+}
+
+void IfConverter::print() const {
+    cerr << "If Converter: merged " << diamonds.size() << " diamonds, "
+         << n_select << " selects" << endl;
+    for (const auto &d : diamonds) {
+        cerr << "  block " << d.head << ": " << d.t << ", " << d.f << " -> "
+             << d.join << (d.merged_join ? " (merged)" : "") << endl;
+    }
+}
+
+}  // namespace hls
@@ -0,0 +1,61 @@
+#ifndef HLS_TRANSFORM_IFCONV_H
+#define HLS_TRANSFORM_IFCONV_H
+
+#include <vector>
+
+#include "io.h"
+
+using std::vector;
+
+namespace hls {
+
+// A branch diamond, head -> {t, f} -> join
+struct Diamond {
+    int head, t, f, join;
+    bool merged_join;  // join has no other preds, so it's merged as well
+};
+
+// Merge small if/else diamonds into a predicated block before scheduling,
+// so both sides share cycles and resources. Ops of the sides (and the join,
+// if only reached from them) move into the block holding the head, and
+// emptied blocks are left in a chain after it with exp_times 0. Sides with
+// loads or stores are never merged, as they can't run unconditionally.
+// PHIs of a merged join become selects on the branch condition, of a new
+// op type on a new mux type taking a cycle and the area of a register
+// (at least 1, so allocators never take it for free). Joins with PHIs are
+// merged only if the head branches on a condition.
+// Op ids are kept, and results are given on the converted input.
+class IfConverter {
+   private:
+    const HLSInput *hin;
+    HLSInput converted;    // input with diamonds merged
+    vector<int> host;      // bbid -> block holding its ops after merging
+    vector<int> min_lats;  // optype -> min latency of compatible types
+    vector<Diamond> diamonds;
+    int max_ops;          // max ops on both sides of a diamond
+    int sel_type = -1;    // optype of selects, -1 until needed
+    int n_select = 0;
+
+    bool match_diamond(int bbid, Diamond &d) const;
+    int get_cond(int head) const;
+    int get_select_type();
+    int get_path_length(const vector<int> &ops, int join, int cond) const;
+    bool is_profitable(const Diamond &d) const;
+    void merge(const Diamond &d);
+
+   public:
+    IfConverter(const HLSInput &hin, int max_ops = 16) : converted(hin) {
+        this->hin = &hin;
+        this->max_ops = max_ops;
+    }
+
+    // Returns the number of merged diamonds.
+    int convert();
+
+    const HLSInput &get_converted() const { return converted; }
+    void print() const;
+};
+
+}  // namespace hls
+
+#endif
@@ -0,0 +1,448 @@
+#include "redundancy.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+
+#include "bind/reg.h"
+#include "graph.h"
+#include "schedule/base.h"
+
+namespace hls {
+
+bool RedundancyEliminator::is_pure(int opid) const {
+    auto opcate = hin->get_opcate(opid);
+    return opcate == OP_ARITHM || opcate == OP_BOOL || opcate == OP_COMPARE;
+}
+
+// Immediate dominator of each block, -1 for the entry and unreachable ones
+vector<int> RedundancyEliminator::get_dominators() const {
+    int n_block = hin->n_block;
+    vector<int> idom(n_block, -1);
+    int entry = -1;
+    for (int bbid = 0; bbid < n_block && entry == -1; bbid++)
+        if (hin->blocks[bbid].n_pred == 0) entry = bbid;
+    if (entry == -1) return idom;
+
+    // reverse post order from the entry
+    vector<int> rpo, index(n_block, -1);
+    vector<bool> visited(n_block, false);
+    vector<pair<int, int>> stack;  // (bbid, next succ)
+    stack.push_back(std::make_pair(entry, 0));
+    visited[entry] = true;
+    while (!stack.empty()) {
+        auto &top = stack.back();
+        const auto &succs = hin->blocks[top.first].succs;
+        if (top.second < succs.size()) {
+            int succ = succs[top.second++];
+            if (!visited[succ]) {
+                visited[succ] = true;
+                stack.push_back(std::make_pair(succ, 0));
+            }
+        } else {
+            rpo.push_back(top.first);
+            stack.pop_back();
+        }
+    }
+    std::reverse(rpo.begin(), rpo.end());
+    for (int i = 0; i < rpo.size(); i++) index[rpo[i]] = i;
+
+    // Cooper, Harvey and Kennedy's iterative algorithm
+    auto intersect = [&](int a, int b) {
+        while (a != b) {
+            while (index[a] > index[b]) a = idom[a];
+            while (index[b] > index[a]) b = idom[b];
+        }
+        return a;
+    };
+    idom[entry] = entry;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto bbid : rpo) {
+            if (bbid == entry) continue;
+            int new_idom = -1;
+            for (auto pred : hin->blocks[bbid].preds) {
+                if (index[pred] == -1 || idom[pred] == -1) continue;
+                new_idom = (new_idom == -1) ? pred : intersect(pred, new_idom);
+            }
+            if (new_idom != idom[bbid]) {
+                idom[bbid] = new_idom;
+                changed = true;
+            }
+        }
+    }
+    idom[entry] = -1;
+    return idom;
+}
+
+// Walk the dominator tree, where values of a block are visible to the
+// blocks it dominates.
+void RedundancyEliminator::number_values() {
+    vector<int> idom = get_dominators();
+    vector<vector<int>> children(hin->n_block);
+    vector<int> roots;
+    for (int bbid = 0; bbid < hin->n_block; bbid++) {
+        if (idom[bbid] == -1)
+            roots.push_back(bbid);
+        else
+            children[idom[bbid]].push_back(bbid);
+    }
+
+    map<pair<int, vector<int>>, int> values;  // (optype, inputs) -> opid
+    std::function<void(int)> visit = [&](int bbid) {
+        vector<pair<int, vector<int>>> added;
+        vector<int> topo;
+        topology_sort(build_induced_graph(bbid, *hin), topo);
+        for (auto opid : topo) {
+            if (!is_pure(opid)) continue;
+            const auto &op = hin->operations[opid];
+            // operands not given as ops, such as constants, may differ
+            if (op.inputs.empty() ||
+                std::any_of(op.inputs.begin(), op.inputs.end(),
+                            [](int in) { return in < 0; }))
+                continue;
+            vector<int> inputs;
+            for (auto in : op.inputs) inputs.push_back(reps[in]);
+            if (hin->is_commutative(op.optype))
+                std::sort(inputs.begin(), inputs.end());
+            auto key = std::make_pair(op.optype, inputs);
+            auto it = values.find(key);
+            if (it != values.end()) {
+                reps[opid] = it->second;
+                n_cse++;
+            } else {
+                values.insert(std::make_pair(key, opid));
+                added.push_back(key);
+            }
+        }
+        for (auto child : children[bbid]) visit(child);
+        for (const auto &key : added) values.erase(key);
+    };
+    for (auto root : roots) visit(root);
+}
+
+// Remove pure ops and loads without users, until none is left
+void RedundancyEliminator::remove_dead() {
+    auto is_removable = [&](int opid) {
+        return is_pure(opid) || hin->get_opcate(opid) == OP_LOAD;
+    };
+    vector<int> n_users(hin->n_operation, 0);
+    for (const auto &op : hin->operations) {
+        if (reps[op.opid] != op.opid) continue;
+        for (auto in : op.inputs)
+            if (in >= 0) n_users[reps[in]]++;
+    }
+
+    queue<int> dead;
+    for (int opid = 0; opid < hin->n_operation; opid++)
+        if (reps[opid] == opid && n_users[opid] == 0 && is_removable(opid))
+            dead.push(opid);
+    while (!dead.empty()) {
+        int opid = dead.front();
+        dead.pop();
+        reps[opid] = -1;
+        n_dead++;
+        for (auto in : hin->operations[opid].inputs) {
+            if (in < 0) continue;
+            int rep = reps[in];
+            if (--n_users[rep] == 0 && is_removable(rep)) dead.push(rep);
+        }
+    }
+}
+
+void RedundancyEliminator::build_reduced() {
+    old2new.assign(hin->n_operation, -1);
+    new2old.clear();
+    for (int opid = 0; opid < hin->n_operation; opid++) {
+        if (reps[opid] != opid) continue;
+        old2new[opid] = new2old.size();
+        new2old.push_back(opid);
+    }
+
+    reduced.n_operation = new2old.size();
+    reduced.operations.clear();
+    for (int opid = 0; opid < reduced.n_operation; opid++) {
+        Operation op = hin->operations[new2old[opid]];
+        op.opid = opid;
+        for (auto &in : op.inputs)
+            if (in >= 0) in = old2new[reps[in]];
+        reduced.operations.push_back(op);
+    }
+    for (auto &bb : reduced.blocks) {
+        vector<int> ops;
+        for (auto opid : bb.ops)
+            if (old2new[opid] != -1) ops.push_back(old2new[opid]);
+        bb.ops = ops;
+        bb.n_op_in_block = ops.size();
+    }
+}
+
+int RedundancyEliminator::eliminate() {
+    users.assign(hin->n_operation, vector<int>());
+    for (const auto &op : hin->operations)
+        for (auto in : op.inputs)
+            if (in >= 0) users[in].push_back(op.opid);
+
+    number_values();
+    remove_dead();
+    build_reduced();
+    return n_cse + n_dead;
+}
+
+// Insts taken by bound ops starting before a cycle
+ReservationTable RedundancyEliminator::get_table(const HLSOutput &hout,
+                                                 int before) const {
+    ReservationTable table(*hin, hout.rinsts);
+    for (int opid = 0; opid < hin->n_operation; opid++) {
+        int cycle = hout.scheds[opid];
+        if (cycle < 0 || cycle >= before || hout.binds[opid] < 0) continue;
+        int rtid = hout.get_rtid(opid);
+        table.reserve_inst(rtid, hout.binds[opid], cycle);
+    }
+    return table;
+}
+
+// Blocks in the order they are laid out: those with scheduled ops by their
+// start, and each other one after the last of those before it in the order
+// of BaseScheduler::sort_basic_block
+vector<int> RedundancyEliminator::get_layout(const HLSOutput &hout) const {
+    int n_block = hin->n_block;
+    vector<int> order;
+    vector<bool> visited(n_block, false);
+    vector<bool> ready_list(hin->n_operation, false);
+    queue<int> bfs;
+    for (int bbid = 0; bbid < n_block && bfs.empty(); bbid++)
+        if (hin->blocks[bbid].n_pred == 0) bfs.push(bbid);
+    while (!bfs.empty()) {
+        int bbid = bfs.front();
+        bfs.pop();
+        if (visited[bbid] || !is_basic_block_ready(bbid, *hin, ready_list))
+            continue;
+        visited[bbid] = true;
+        order.push_back(bbid);
+        for (auto opid : hin->blocks[bbid].ops) ready_list[opid] = true;
+        for (auto succ : hin->blocks[bbid].succs) bfs.push(succ);
+    }
+    for (int bbid = 0; bbid < n_block; bbid++)
+        if (!visited[bbid]) order.push_back(bbid);
+
+    vector<pair<int, int>> ranged;           // (start, bbid)
+    vector<vector<int>> after(n_block + 1);  // bbid -> blocks without range
+    int last = n_block;                      // n_block for the front
+    for (auto bbid : order) {
+        int start, end;
+        if (hout.get_block_range(bbid, start, end)) {
+            ranged.push_back(std::make_pair(start, bbid));
+            last = bbid;
+        } else {
+            after[last].push_back(bbid);
+        }
+    }
+    std::sort(ranged.begin(), ranged.end());
+    vector<int> layout = after[n_block];
+    for (const auto &r : ranged) {
+        layout.push_back(r.second);
+        layout.insert(layout.end(), after[r.second].begin(),
+                      after[r.second].end());
+    }
+    return layout;
+}
+
+// End of the last block with ops laid out before bbid and start of the first
+// one after it, 0 and INT_MAX if none
+void RedundancyEliminator::get_bounds(const HLSOutput &hout,
+                                      const vector<int> &layout, int bbid,
+                                      int &lower, int &upper) const {
+    int pos = std::find(layout.begin(), layout.end(), bbid) - layout.begin();
+    int start, end;
+    lower = 0;
+    upper = INT_MAX;
+    for (int i = pos - 1; i >= 0; i--) {
+        if (hout.get_block_range(layout[i], start, end)) {
+            lower = end;
+            break;
+        }
+    }
+    for (int i = pos + 1; i < layout.size(); i++) {
+        if (hout.get_block_range(layout[i], start, end)) {
+            upper = start;
+            break;
+        }
+    }
+}
+
+// Earliest cycle a removed op could start, after its inputs in block and
+// the start of its block, or the end of the block laid out before if its
+// block has no ops left. Inputs from other blocks end before either.
+int RedundancyEliminator::get_ready(const HLSOutput &hout,
+                                    const vector<int> &layout,
+                                    int opid) const {
+    int bbid = hin->operations[opid].bbid;
+    int start, end, upper;
+    int ready;
+    if (hout.get_block_range(bbid, start, end))
+        ready = start;
+    else
+        get_bounds(hout, layout, bbid, ready, upper);
+    for (auto in : hin->operations[opid].inputs) {
+        if (in < 0 || hout.scheds[in] < 0) continue;
+        if (hin->operations[in].bbid != bbid) continue;
+        if (!hin->need_schedule(hin->get_opcate(in))) continue;
+        ready = std::max(ready, hout.scheds[in] + hout.get_latency(in) + 1);
+    }
+    return ready;
+}
+
+// Latest cycle a removed op could start, finishing before the end of its
+// block, or the start of the block laid out after if its block has no ops
+// left, and before its users in block. Users not placed yet need time for
+// themselves. Users in later blocks start after either.
+int RedundancyEliminator::get_latest(const HLSOutput &hout,
+                                     const vector<int> &layout, int opid,
+                                     map<int, int> &memo) const {
+    auto it = memo.find(opid);
+    if (it != memo.end()) return it->second;
+
+    int bbid = hin->operations[opid].bbid;
+    int lat = hout.get_latency(opid);
+    int start, end;
+    if (!hout.get_block_range(bbid, start, end))
+        get_bounds(hout, layout, bbid, start, end);
+    int latest = (end == INT_MAX) ? INT_MAX : end - lat - 1;
+    for (auto user : users[opid]) {
+        if (hin->operations[user].bbid != bbid) continue;
+        if (!hin->need_schedule(hin->get_opcate(user))) continue;
+        int limit = hout.scheds[user];
+        if (limit < 0) {
+            limit = get_latest(hout, layout, user, memo);
+            if (limit == INT_MAX) continue;
+        }
+        latest = std::min(latest, limit - lat - 1);
+    }
+    return memo[opid] = latest;
+}
+
+// Place a removed op on a free inst in time for its users, keeping its
+// block where it is laid out. If no slot is left, add an inst within the
+// area limit, or delay ops from its deadline on, which keeps their
+// dependencies and insts and opens a gap for a block without ops.
+// Returns 0 on success, -1 on errors, including a type left without insts
+// and no area for one.
+int RedundancyEliminator::place(HLSOutput &hout, ReservationTable &table,
+                                const vector<int> &layout, int opid) const {
+    auto opcate = hin->get_opcate(opid);
+    if (!hin->need_schedule(opcate)) return 0;
+    int rtid = hout.get_rtid(opid);
+    if (rtid == -1) {
+        cerr << "Redundancy Eliminator Error: Op " << opid
+             << " has no resource type" << endl;
+        return -1;
+    }
+    bool need_bind = hin->need_bind(opcate);
+    int area = hin->resource_types[rtid].area;
+    if (need_bind && hout.rinsts[rtid] == 0) {
+        // all ops of rtid were removed, while tables take 0 as no limit
+        if (hout.get_area() + area > hin->area_limit) {
+            cerr << "Redundancy Eliminator Error: No area for an inst of "
+                 << "resource type " << rtid << endl;
+            return -1;
+        }
+        hout.rinsts[rtid] = 1;
+        table = get_table(hout, INT_MAX);
+    }
+    int lat = hout.get_latency(opid);
+    map<int, int> memo;
+    int ready = get_ready(hout, layout, opid);
+    int latest = get_latest(hout, layout, opid, memo);
+
+    int cycle = ready;
+    int inst = need_bind ? table.first_free_inst(rtid, cycle) : 0;
+    while (inst == -1 && cycle < latest)
+        inst = table.first_free_inst(rtid, ++cycle);
+    if ((inst == -1 || cycle > latest) && need_bind && ready <= latest &&
+        hout.get_area() + area <= hin->area_limit) {
+        // spend area left on a new inst
+        cycle = ready;
+        inst = hout.rinsts[rtid]++;
+        table = get_table(hout, INT_MAX);
+    } else if (inst == -1 || cycle > latest) {
+        // inputs end by ready, so they are never delayed past the op
+        int from = std::max(latest + lat + 1, ready);
+        ReservationTable before = get_table(hout, from);
+        cycle = ready;
+        inst = need_bind ? before.first_free_inst(rtid, cycle) : 0;
+        while (inst == -1) inst = before.first_free_inst(rtid, ++cycle);
+        int delta = cycle + lat + 1 - from;
+        for (auto &sched : hout.scheds)
+            if (sched >= from) sched += delta;
+        table = get_table(hout, INT_MAX);
+    }
+
+    hout.scheds[opid] = cycle;
+    if (need_bind) {
+        hout.binds[opid] = inst;
+        table.reserve_inst(rtid, inst, cycle);
+    }
+    return 0;
+}
+
+int RedundancyEliminator::copyout(const HLSOutput &hout_reduced,
+                                  HLSOutput &hout) const {
+    hout.ot2rtid = hout_reduced.ot2rtid;
+    hout.insts = hout_reduced.insts;
+    hout.rinsts = hout_reduced.rinsts;
+    hout.n_reg = hout_reduced.n_reg;
+    for (int opid = 0; opid < hin->n_operation; opid++) {
+        int k = old2new[opid];
+        hout.scheds[opid] = (k == -1) ? -1 : hout_reduced.scheds[k];
+        hout.binds[opid] = (k == -1) ? -1 : hout_reduced.binds[k];
+        hout.op2rtid[opid] = (k == -1) ? -1 : hout_reduced.op2rtid[k];
+    }
+    if (new2old.size() == hin->n_operation) return 0;
+
+    // place removed ops in topology order, ignoring phi inputs
+    vector<int> n_wait(hin->n_operation, 0);
+    for (const auto &op : hin->operations) {
+        if (hin->get_opcate(op.opid) == OP_PHI) continue;
+        for (auto in : op.inputs)
+            if (in >= 0) n_wait[op.opid]++;
+    }
+    queue<int> ready;
+    for (int opid = 0; opid < hin->n_operation; opid++)
+        if (n_wait[opid] == 0) ready.push(opid);
+    ReservationTable table = get_table(hout, INT_MAX);
+    vector<int> layout = get_layout(hout);
+    int cnt = 0;
+    while (!ready.empty()) {
+        int opid = ready.front();
+        ready.pop();
+        cnt++;
+        if (old2new[opid] == -1 && place(hout, table, layout, opid) < 0) return -1;
+        for (auto user : users[opid]) {
+            if (hin->get_opcate(user) == OP_PHI) continue;
+            if (--n_wait[user] == 0) ready.push(user);
+        }
+    }
+    if (cnt != hin->n_operation) {
+        cerr << "Redundancy Eliminator Error: Loops in dependencies" << endl;
+        return -1;
+    }
+
+    // placed values and gaps change lifetimes
+    RegisterBinder reg_binder(*hin, hout);
+    if (reg_binder.analyze() < 0 || reg_binder.bind() < 0) return -1;
+    reg_binder.copyout(hout);
+    if (hout.get_area() > hin->area_limit)
+        cerr << "Warning: Registers exceed the area limit after placing "
+             << "removed ops" << endl;
+    return 0;
+}
+
+void RedundancyEliminator::print() const {
+    cerr << "Redundancy Eliminator: removed " << n_cse
+         << " common subexpressions and " << n_dead << " dead ops of "
+         << hin->n_operation << endl;
+}
+
+}  // namespace hls
@@ -0,0 +1,73 @@
+#ifndef HLS_TRANSFORM_REDUNDANCY_H
+#define HLS_TRANSFORM_REDUNDANCY_H
+
+#include <numeric>
+#include <vector>
+
+#include "io.h"
+#include "reservation.h"
+
+using std::vector;
+
+namespace hls {
+
+// Remove common subexpressions and dead ops before scheduling.
+// Pure ops (arithmetic, boolean, compare) computing the same optype on the
+// same values share one value number, and an op reuses the value of an
+// equal op in its block or a dominating one. Ops without inputs or with
+// operands not given as ops are never numbered, as those operands are
+// unknown and may differ. Pure ops and loads no longer
+// used are removed. The flow runs on the reduced input, and removed ops
+// are placed back into the result on free insts before their users and
+// within the cycles of their blocks as laid out, adding insts with area
+// left, or opening a gap in the schedule.
+class RedundancyEliminator {
+   private:
+    const HLSInput *hin;
+    HLSInput reduced;         // input without removed ops
+    vector<int> reps;         // opid -> op giving its value, -1 if dead
+    vector<int> old2new;      // original opid -> reduced opid, -1 if removed
+    vector<int> new2old;      // reduced opid -> original opid
+    vector<vector<int>> users;  // opid -> ops reading it
+    int n_cse = 0, n_dead = 0;
+
+    bool is_pure(int opid) const;
+    vector<int> get_dominators() const;
+    void number_values();
+    void remove_dead();
+    void build_reduced();
+
+    // Placing removed ops back
+    vector<int> get_layout(const HLSOutput &hout) const;
+    void get_bounds(const HLSOutput &hout, const vector<int> &layout, int bbid,
+                    int &lower, int &upper) const;
+    int get_ready(const HLSOutput &hout, const vector<int> &layout,
+                  int opid) const;
+    int get_latest(const HLSOutput &hout, const vector<int> &layout, int opid,
+                   map<int, int> &memo) const;
+    ReservationTable get_table(const HLSOutput &hout, int before) const;
+    int place(HLSOutput &hout, ReservationTable &table,
+              const vector<int> &layout, int opid) const;
+
+   public:
+    RedundancyEliminator(const HLSInput &hin) : reduced(hin) {
+        this->hin = &hin;
+        reps.resize(hin.n_operation);
+        std::iota(reps.begin(), reps.end(), 0);
+        old2new = new2old = reps;
+    }
+
+    // Returns the number of removed ops.
+    int eliminate();
+
+    const HLSInput &get_reduced() const { return reduced; }
+
+    // Map results on the reduced input back to the original one, placing
+    // removed ops. Returns 0 on success, -1 on errors.
+    int copyout(const HLSOutput &hout_reduced, HLSOutput &hout) const;
+    void print() const;
+};
+
+}  // namespace hls
+
+#endif
@@ -0,0 +1,122 @@
+#include "reweight.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <string>
+
+namespace hls {
+
+static const int max_round = 1000;     // rounds to solve loops
+static const float tolerance = 1e-4f;  // relative change at a fixed point
+
+int Reweighter::load(const char *filename) {
+    std::ifstream fin(filename);
+    if (!fin) {
+        cerr << "Reweighter Error: Cannot open profile " << filename << endl;
+        return -1;
+    }
+    std::string kind;
+    while (fin >> kind) {
+        if (kind == "block") {
+            int bbid;
+            float count;
+            if (!(fin >> bbid >> count)) break;
+            if (bbid < 0 || bbid >= hin->n_block || count < 0) {
+                cerr << "Reweighter Error: Bad count of block " << bbid
+                     << endl;
+                return -1;
+            }
+            counts[bbid] = count;
+        } else if (kind == "branch") {
+            int bbid, succ;
+            float prob;
+            if (!(fin >> bbid >> succ >> prob)) break;
+            bool found = false;
+            if (bbid >= 0 && bbid < hin->n_block)
+                for (auto s : hin->blocks[bbid].succs) found |= (s == succ);
+            if (!found || prob < 0 || prob > 1) {
+                cerr << "Reweighter Error: Bad branch " << bbid << " -> "
+                     << succ << endl;
+                return -1;
+            }
+            probs[std::make_pair(bbid, succ)] = prob;
+        } else {
+            cerr << "Reweighter Error: Unknown entry " << kind << endl;
+            return -1;
+        }
+    }
+    if (!fin.eof()) {
+        cerr << "Reweighter Error: Corrupted profile " << filename << endl;
+        return -1;
+    }
+    return 0;
+}
+
+// Probability of an edge, given or shared from what's left of its block
+float Reweighter::get_prob(int bbid, int succ) const {
+    auto it = probs.find(std::make_pair(bbid, succ));
+    if (it != probs.end()) return it->second;
+    float left = 1;
+    int n_free = 0;
+    for (auto s : hin->blocks[bbid].succs) {
+        auto jt = probs.find(std::make_pair(bbid, s));
+        if (jt != probs.end())
+            left -= jt->second;
+        else
+            n_free++;
+    }
+    return std::max(left, 0.0f) / n_free;
+}
+
+int Reweighter::reweight() {
+    vector<float> weights(hin->n_block);
+    vector<bool> derived(hin->n_block, false);
+    for (const auto &bb : hin->blocks) {
+        weights[bb.bbid] = bb.exp_times;
+        if (counts[bb.bbid] >= 0) {
+            weights[bb.bbid] = counts[bb.bbid];
+            continue;
+        }
+        for (auto pred : bb.preds)
+            if (probs.count(std::make_pair(pred, bb.bbid)))
+                derived[bb.bbid] = true;
+    }
+
+    // Gauss-Seidel over derived blocks
+    for (int round = 0; round < max_round; round++) {
+        bool stable = true;
+        for (const auto &bb : hin->blocks) {
+            if (!derived[bb.bbid]) continue;
+            float w = 0;
+            for (auto pred : bb.preds)
+                w += weights[pred] * get_prob(pred, bb.bbid);
+            if (std::fabs(w - weights[bb.bbid]) >
+                tolerance * std::max(w, 1.0f))
+                stable = false;
+            weights[bb.bbid] = w;
+        }
+        if (stable) break;
+    }
+
+    n_changed = 0;
+    for (auto &bb : reweighted.blocks) {
+        if (bb.exp_times == weights[bb.bbid]) continue;
+        bb.exp_times = weights[bb.bbid];
+        n_changed++;
+    }
+    return n_changed;
+}
+
+void Reweighter::print() const {
+    cerr << "Reweighter: " << n_changed << " of " << hin->n_block
+         << " blocks reweighted" << endl;
+    for (const auto &bb : reweighted.blocks) {
+        float old = hin->blocks[bb.bbid].exp_times;
+        if (bb.exp_times != old)
+            cerr << "  block " << bb.bbid << ": " << old << " -> "
+                 << bb.exp_times << endl;
+    }
+}
+
+}  // namespace hls
@@ -0,0 +1,52 @@
+#ifndef HLS_TRANSFORM_REWEIGHT_H
+#define HLS_TRANSFORM_REWEIGHT_H
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "io.h"
+
+using std::map;
+using std::pair;
+using std::vector;
+
+namespace hls {
+
+// Override exp_times of blocks with a measured profile.
+// A profile has lines of
+//   block <bbid> <count>        measured execution count of a block
+//   branch <bbid> <succ> <prob> probability of taking an edge
+// Unmeasured blocks with a given probability on some incoming edge get
+// the sum of count * probability over their preds, where edges without
+// one share what's left of their block evenly. Loops are solved by
+// iterating to a fixed point. Other blocks keep their static estimates.
+// Ops and blocks are kept, so results are valid on the original input.
+class Reweighter {
+   private:
+    const HLSInput *hin;
+    HLSInput reweighted;
+    vector<float> counts;              // bbid -> measured count, -1 if none
+    map<pair<int, int>, float> probs;  // (bbid, succ) -> probability
+    int n_changed = 0;
+
+    float get_prob(int bbid, int succ) const;
+
+   public:
+    Reweighter(const HLSInput &hin) : reweighted(hin) {
+        this->hin = &hin;
+        counts.resize(hin.n_block, -1);
+    }
+
+    // Returns 0 on success, -1 on errors.
+    int load(const char *filename);
+    // Returns the number of blocks whose exp_times changed.
+    int reweight();
+
+    const HLSInput &get_reweighted() const { return reweighted; }
+    void print() const;
+};
+
+}  // namespace hls
+
+#endif